@@ -24,6 +24,11 @@
 #include "stdafx.h"
 #include "HexadokuSolver.h"
 #include "HexadokuSolverDlg.h"
+#include "CBatchSolver.h"
+#include "CBitboardSolver.h"
+#include "CGenerator.h"
+#include "CLayoutReader.h"
+#include <fstream>
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -50,6 +55,130 @@ CHexadokuSolverApp theApp;
 
 //////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+//! the report goes to the console of the caller or into a message box
+void ShowReport( const CString & report )
+{
+  if(AttachConsole(ATTACH_PARENT_PROCESS))
+  {
+    const HANDLE console = CreateFileW(L"CONOUT$", GENERIC_WRITE, FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+
+    if(INVALID_HANDLE_VALUE != console)
+    {
+      DWORD written = 0;
+      WriteConsoleW(console, report.GetString(), report.GetLength(), &written, NULL);
+      CloseHandle(console);
+    }
+
+    FreeConsole();
+  }
+  else
+  {
+    AfxMessageBox(report, MB_OK);
+  }
+}
+
+//! solves a file of puzzles, the stats of each one go into a JSON file next to the solutions,
+//! a matching of on or off overrides the orders the bitboard backend matches on
+void RunBatch( const wchar_t* input, const wchar_t* output, const wchar_t* matching )
+{
+  if(NULL != matching && 0 != _wcsicmp(matching, L"on") && 0 != _wcsicmp(matching, L"off"))
+  {
+    AfxMessageBox(L"The matching is either on or off!", MB_OK);
+    return;
+  }
+
+  const std::wstring target = NULL != output ? std::wstring(output) : std::wstring(input) + L".solved";
+
+  std::ifstream in(input);
+  std::ofstream out(target.c_str());
+  std::ofstream stats((target + L".json").c_str());
+
+  if(!in || !out || !stats)
+  {
+    AfxMessageBox(L"The puzzle files could not be opened!", MB_OK);
+    return;
+  }
+
+  // on matches on every order, off on none, to time the same corpus both ways
+  if(NULL != matching)
+  {
+    Sudoku::CBitboardSolver::SetMatching(0 == _wcsicmp(matching, L"on") ? Sudoku::CBitboardSolver::MatchAll : Sudoku::CBitboardSolver::MatchNone);
+  }
+
+  Sudoku::CBatchSolver batch;
+  CGrid layout;
+
+  // a puzzle taking longer than this is most likely a broken one
+  batch.SetTimeLimit(10000UL);
+
+  // most puzzles of a corpus need no search at all
+  batch.UseLockstep(true);
+
+  // jigsaw and diagonal variants come with a description next to the puzzles
+  if(Sudoku::CLayoutReader::Load((std::wstring(input) + L".layout").c_str(), layout))
+  {
+    batch.SetLayout(layout);
+  }
+
+  const bool ok = batch.Run(in, out, &stats);
+
+  CString report(batch.Report().ToString().c_str());
+
+  if(!ok)
+  {
+    report += L"Reading or writing the puzzle files failed!\n";
+  }
+
+  ShowReport(report);
+}
+
+//! generates a file of unique puzzles and optionally one of their solutions
+void RunGenerator( const wchar_t* size, const wchar_t* count, const wchar_t* seed, const wchar_t* givens, const wchar_t* output, const wchar_t* solutions )
+{
+  unsigned int order = 0;
+
+  for(unsigned int i=CGrid::MinOrder; i<=CGrid::MaxOrder; ++i)
+  {
+    if(wcstoul(size, NULL, 10) == i * i)
+    {
+      order = i;
+    }
+  }
+
+  std::ofstream out(output);
+  std::ofstream sol;
+
+  if(NULL != solutions)
+  {
+    sol.open(solutions);
+  }
+
+  if(0 == order || !out || (NULL != solutions && !sol))
+  {
+    AfxMessageBox(L"The puzzle size is unknown or the puzzle files could not be opened!", MB_OK);
+    return;
+  }
+
+  Sudoku::CGenerator generator;
+  const bool ok = generator.Run(order, wcstoul(count, NULL, 10), wcstoul(seed, NULL, 10),
+                                wcstoul(givens, NULL, 10), out, NULL != solutions ? &sol : NULL);
+
+  CString report(generator.Report().ToString().c_str());
+
+  if(!ok)
+  {
+    report += L"Writing the puzzle files failed!\n";
+  }
+
+  ShowReport(report);
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
 BOOL CHexadokuSolverApp::InitInstance()
 {
   INITCOMMONCONTROLSEX InitCtrls;
@@ -58,6 +187,35 @@ BOOL CHexadokuSolverApp::InitInstance()
   InitCommonControlsEx(&InitCtrls);
 
   CWinApp::InitInstance();
+
+  // HexadokuSolver.exe /batch <puzzles> [<solutions>] [/matching on|off] runs without any dialog
+  if(__argc >= 3 && 0 == _wcsicmp(__wargv[1], L"/batch"))
+  {
+    const wchar_t* output = NULL;
+    const wchar_t* matching = NULL;
+
+    for(int i=3; i<__argc; ++i)
+    {
+      if(0 == _wcsicmp(__wargv[i], L"/matching") && i + 1 < __argc)
+      {
+        matching = __wargv[++i];
+      }
+      else
+      {
+        output = __wargv[i];
+      }
+    }
+
+    RunBatch(__wargv[2], output, matching);
+    return FALSE;
+  }
+
+  // HexadokuSolver.exe /generate <9|16|25|36> <count> <seed> <givens> <puzzles> [<solutions>]
+  if(__argc >= 7 && 0 == _wcsicmp(__wargv[1], L"/generate"))
+  {
+    RunGenerator(__wargv[2], __wargv[3], __wargv[4], __wargv[5], __wargv[6], __argc >= 8 ? __wargv[7] : NULL);
+    return FALSE;
+  }
   AfxEnableControlContainer();
 
   CShellManager *pShellManager = new CShellManager;
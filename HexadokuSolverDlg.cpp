@@ -25,15 +25,26 @@
 #include "HexadokuSolver.h"
 #include "HexadokuSolverDlg.h"
 #include "CScannerManager.h"
+#include "CSolverFactory.h"
+#include "CLayoutReader.h"
+#include "CPuzzleCache.h"
+#include "CStatsWriter.h"
 #include "afxdialogex.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
 #endif
 
+//! the time a scanned Sudoku may take before the operator sees how far the solver got
+#define SOLVE_TIMEOUT_MS 10000UL
+
+//! tells the dialog that the solve in the background has ended
+#define WM_APP_SOLVED (WM_APP + 1)
+
 //////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <shlobj.h>
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -74,9 +85,75 @@ CHexadokuSolverDlg::CHexadokuSolverDlg(CWnd* pParent /*=NULL*/)
     m_ScannerManager( WIA2::CScannerManager::GetInstance() ),
     m_ContainerScanner( m_ScannerManager.Scanners() ),
     m_Scanner(NULL),
-    m_Combobox(NULL)    
+    m_Combobox(NULL),
+    m_Recognizer(NULL),
+    m_Solver(NULL),
+    m_Parallel(NULL),
+    m_Verifier(NULL),
+    m_Grader(NULL),
+    m_Cache(NULL),
+    m_Streaming(),
+    m_Reading(),
+    m_Estimator(),
+    m_Async(),
+    m_Result(),
+    m_Givens(),
+    m_Glyphs(),
+    m_hasGlyphs(false),
+    m_isResolving(false),
+    m_isRunaway(false),
+    m_Layout(),
+    m_hasLayout(false),
+    m_StatsFolder()
 {
   m_hIcon = AfxGetApp()->LoadIcon(IDR_MAINFRAME);
+
+  m_Verifier = Sudoku::CSolverFactory::Instance().CreateVerifier();
+  m_Grader = Sudoku::CSolverFactory::Instance().CreateGrader();
+  m_Parallel = Sudoku::CSolverFactory::Instance().Create(ISolverFactory::Parallel);
+  SelectSolver(ISolverFactory::Bitboard);
+
+  // probing the search tree of a sparse big grid takes seconds, it is done along with the solve
+  m_Async.UseEstimator(&m_Estimator, m_Parallel);
+
+  // solutions of earlier scans are kept in the local application data
+  wchar_t path[MAX_PATH] = { 0 };
+  CString stats;
+
+  if(SUCCEEDED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA | CSIDL_FLAG_CREATE, NULL, SHGFP_TYPE_CURRENT, path)))
+  {
+    CString file(path);
+
+    file += L"\\HexadokuSolver";
+    CreateDirectoryW(file, NULL);
+    stats = file + L"\\Stats";
+
+    const CString database = file + L"\\solved.db";
+    const CString text = file + L"\\solved.txt";
+    const bool fresh = INVALID_FILE_ATTRIBUTES == GetFileAttributesW(database);
+
+    m_Cache = Sudoku::CSolverFactory::Instance().CreateCache(database);
+
+    // the text file of older versions is copied into a new database, it stays as it is
+    if(fresh && INVALID_FILE_ATTRIBUTES != GetFileAttributesW(text))
+    {
+      const Sudoku::CPuzzleCache older(text);
+
+      older.CopyTo(*m_Cache);
+    }
+  }
+  else
+  {
+    m_Cache = Sudoku::CSolverFactory::Instance().CreateCache(NULL);
+  }
+
+  // what the solver did goes into a file per scan, the profile of the application may move the folder
+  m_StatsFolder = AfxGetApp()->GetProfileString(L"Solver", L"StatsFolder", stats);
+
+  if(!m_StatsFolder.IsEmpty())
+  {
+    CreateDirectoryW(m_StatsFolder, NULL);
+  }
 }
 
 
@@ -85,6 +162,21 @@ CHexadokuSolverDlg::~CHexadokuSolverDlg()
   try
   {
     Cleanup();
+
+    Sudoku::CSolverFactory::Instance().Recycle(m_Solver);
+    m_Solver = NULL;
+
+    Sudoku::CSolverFactory::Instance().Recycle(m_Parallel);
+    m_Parallel = NULL;
+
+    Sudoku::CSolverFactory::Instance().Recycle(m_Verifier);
+    m_Verifier = NULL;
+
+    Sudoku::CSolverFactory::Instance().Recycle(m_Grader);
+    m_Grader = NULL;
+
+    Sudoku::CSolverFactory::Instance().Recycle(m_Cache);
+    m_Cache = NULL;
   }
   catch (...)
   {
@@ -106,8 +198,10 @@ BEGIN_MESSAGE_MAP(CHexadokuSolverDlg, CDialogEx)
   ON_WM_CLOSE()
   ON_WM_DESTROY()
   ON_BN_CLICKED(IDC_BUTTON_START, &CHexadokuSolverDlg::OnBnClickedButtonStart)
+  ON_BN_CLICKED(IDC_BUTTON_LAYOUT, &CHexadokuSolverDlg::OnBnClickedButtonLayout)
   ON_CBN_SELCHANGE(IDC_COMBO_DEVICE, &CHexadokuSolverDlg::OnCbnSelchangeDevice)
   ON_MESSAGE( WM_APP, &CHexadokuSolverDlg::OnUserMessage)
+  ON_MESSAGE( WM_APP_SOLVED, &CHexadokuSolverDlg::OnSolveMessage)
 END_MESSAGE_MAP()
 
 //////////////////////////////////////////////////////////////////////////
@@ -185,6 +279,20 @@ LPARAM CHexadokuSolverDlg::OnUserMessage(WPARAM wParam, LPARAM lParam)
   return 0;
 }
 
+LRESULT CHexadokuSolverDlg::OnSolveMessage(WPARAM wParam, LPARAM lParam)
+{
+  // the message of a solve replaced meanwhile finds the next one not ready yet
+  if(m_Result.valid() && std::future_status::ready == m_Result.wait_for(std::chrono::seconds(0)))
+  {
+    const CSolveResult result = m_Result.get();
+    m_Result = std::shared_future<CSolveResult>();
+
+    FinishSolve(result);
+  }
+
+  return 0;
+}
+
 void CHexadokuSolverDlg::OnSysCommand(UINT nID, LPARAM lParam)
 {
   if ((nID & 0xFFF0) == IDM_ABOUTBOX)
@@ -244,8 +352,15 @@ void CHexadokuSolverDlg::OnBnClickedButtonStart()
       {
         doc->Image().Subscribe(*this);
 
+        // the givens are read and propagated while the scan comes in
+        m_Streaming.Start(m_Recognizer);
+        doc->Image().Subscribe(m_Streaming);
+
         doc->Download();
+        doc->Image().Unsubscribe(m_Streaming);
         doc->Image().Save( L"c:\\temp\\blub.bmp" );
+
+        SolveDocument(*doc);
       }
     }
 
@@ -253,6 +368,223 @@ void CHexadokuSolverDlg::OnBnClickedButtonStart()
   }
 }
 
+void CHexadokuSolverDlg::SetRecognizer( IGridRecognizer* recognizer )
+{
+  m_Recognizer = recognizer;
+}
+
+void CHexadokuSolverDlg::OnBnClickedButtonLayout()
+{
+  CFileDialog dialog(TRUE, L"layout", NULL, OFN_FILEMUSTEXIST | OFN_HIDEREADONLY, L"Layouts (*.layout)|*.layout||", this);
+
+  // cancelling the choice goes back to plain Sudokus
+  m_hasLayout = false;
+
+  if(IDOK != dialog.DoModal())
+  {
+    return;
+  }
+
+  if(!Sudoku::CLayoutReader::Load(dialog.GetPathName(), m_Layout))
+  {
+    AfxMessageBox(L"The layout could not be read, the scans are solved as plain Sudokus!", MB_OK);
+    return;
+  }
+
+  m_hasLayout = !m_Layout.isStandard();
+}
+
+void CHexadokuSolverDlg::SelectSolver( ISolverFactory::Backend backend )
+{
+  const ISolverFactory & factory = Sudoku::CSolverFactory::Instance();
+
+  ISolver* const solver = factory.Create(backend);
+
+  // waits for a solve still using the old backend
+  m_Async.Use(solver, m_Verifier, &m_Reading);
+
+  factory.Recycle(m_Solver);
+  m_Solver = solver;
+}
+
+void CHexadokuSolverDlg::SolveDocument( ::IDocument & doc )
+{
+  // nothing to solve without the recognizer and the backends
+  if(NULL == m_Recognizer || NULL == m_Solver || NULL == m_Parallel || NULL == m_Verifier || NULL == m_Grader || NULL == m_Cache)
+  {
+    return;
+  }
+
+  CGrid grid;
+
+  if(!m_Streaming.Finish(doc.Image(), grid))
+  {
+    return;
+  }
+
+  // the regions of a jigsaw or diagonal variant are picked by the operator, a scan of another order stays plain
+  const bool variant = m_hasLayout && m_Layout.Order() == grid.Order();
+
+  if(variant)
+  {
+    grid.SetLayout(m_Layout);
+  }
+
+  // a puzzle scanned before, maybe transposed or relabelled, is already verified
+  CGrid solution(grid);
+
+  if(m_Cache->Lookup(solution))
+  {
+    ShowSolution(solution, m_Grader->Rate(grid));
+    return;
+  }
+
+  // the propagation while scanning only knows the boxes of the plain puzzle
+  const bool misread = !variant && m_Streaming.isContradictory();
+
+  // the cells forced while scanning belong to every solution of the givens
+  if(!variant && !misread)
+  {
+    solution = m_Streaming.Forced();
+  }
+
+  // the document may be gone by the time the solve ends
+  m_Givens = grid;
+  m_Glyphs = CReading(grid.Order());
+  m_hasGlyphs = m_Recognizer->RecognizeGlyphs(doc.Image(), m_Glyphs);
+  m_isResolving = false;
+  m_isRunaway = false;
+
+  // never trust an answer to misread givens, FinishSolve() tries the other guesses of the recognizer
+  if(misread)
+  {
+    m_Async.Cancel();
+    m_Async.Wait();
+    m_Result = std::shared_future<CSolveResult>();
+
+    CSolveResult result;
+    result.m_Status = CSolveResult::Contradictory;
+
+    FinishSolve(result);
+    return;
+  }
+
+  // a hostile grid must not freeze the dialog, the estimate runs in the background along with the solve
+  // and the outcome comes back as a message
+  m_Result = m_Async.Start(solution, SOLVE_TIMEOUT_MS, Sudoku::CCancelToken(), this);
+}
+
+void CHexadokuSolverDlg::FinishSolve( const CSolveResult & result )
+{
+  CGrid grid(m_Givens);
+  CGrid solution(result.m_Grid);
+  CSolveStats stats(result.m_Stats);
+
+  switch(result.m_Status)
+  {
+  case CSolveResult::Solved:
+    // the givens picked among the guesses were proved to have this solution only
+    if(m_isResolving)
+    {
+      grid = result.m_Givens;
+    }
+    break;
+
+  case CSolveResult::Cancelled:
+    return;
+
+  case CSolveResult::TimedOut:
+    ShowGrid(L"The scanned Sudoku could not be solved in time, the solver got this far:\n\n", solution);
+    return;
+
+  default:
+    // a grid estimated to search far beyond the timeout is most likely misread as well
+    if(CSolveResult::Runaway == result.m_Status)
+    {
+      m_isRunaway = true;
+    }
+
+    // the other guesses of the recognizer mostly spare the operator a rescan, the outcome comes back as a message
+    if(!m_isResolving && m_hasGlyphs)
+    {
+      StartResolve();
+      return;
+    }
+
+    if(m_isRunaway)
+    {
+      AfxMessageBox(L"The scanned Sudoku would take far too long to solve, a cell was probably misread!", MB_OK);
+    }
+    else if(CSolveResult::Ambiguous == result.m_Status)
+    {
+      AfxMessageBox(L"The scanned Sudoku has more than one solution, a cell was probably misread!", MB_OK);
+    }
+    else
+    {
+      AfxMessageBox(L"The scanned Sudoku has no solution, a cell was probably misread!", MB_OK);
+    }
+
+    return;
+  }
+
+  m_Cache->Insert(grid, solution, stats);
+
+  // scans are told apart by the time they were solved
+  if(!m_StatsFolder.IsEmpty())
+  {
+    SYSTEMTIME now;
+    CString path;
+
+    GetLocalTime(&now);
+    path.Format(L"%s\\%04u-%02u-%02u %02u-%02u-%02u.%03u.json", static_cast<LPCTSTR>(m_StatsFolder), now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond, now.wMilliseconds);
+
+    if(!Sudoku::CStatsWriter::Save(stats, path))
+    {
+      AfxMessageBox(L"The statistics of the solve could not be written to " + path, MB_OK);
+    }
+  }
+
+  ShowSolution(solution, m_Grader->Rate(grid));
+}
+
+void CHexadokuSolverDlg::StartResolve()
+{
+  m_isResolving = true;
+  m_Result = m_Async.Start(m_Givens, m_Glyphs, SOLVE_TIMEOUT_MS, Sudoku::CCancelToken(), this);
+}
+
+void CHexadokuSolverDlg::ShowSolution( const CGrid & grid, IGrader::Grade grade )
+{
+  CString str;
+
+  str.Format(L"Difficulty: %s\n\n", m_Grader->GetName(grade));
+
+  ShowGrid(str, grid);
+}
+
+void CHexadokuSolverDlg::ShowGrid( const CString & text, const CGrid & grid )
+{
+  CString str(text);
+
+  for(unsigned int row=0; row<grid.Size(); ++row)
+  {
+    for(unsigned int col=0; col<grid.Size(); ++col)
+    {
+      str.AppendChar( grid.Symbol( grid.Get(row, col) ) );
+    }
+
+    str.AppendChar(L'\n');
+  }
+
+  AfxMessageBox(str, MB_OK);
+}
+
+void CHexadokuSolverDlg::OnSolveEvent( const CSolveResult & result ) const
+{
+  // the solving thread must not touch the dialog, the result is fetched from the future
+  ::PostMessage(GetSafeHwnd(), WM_APP_SOLVED, 0, 0);
+}
+
 void CHexadokuSolverDlg::OnImageEvent( const IImage & img ) const
 {
   // TODO: use message queue
@@ -388,6 +720,10 @@ void CHexadokuSolverDlg::OnCbnSelchangeDevice()
 
 void CHexadokuSolverDlg::Cleanup()
 {
+  // the solvers are released right after, a solve must not outlive them
+  m_Async.Cancel();
+  m_Async.Wait();
+
   m_ScannerManager.Cleanup();
 
   m_Scanner = NULL;
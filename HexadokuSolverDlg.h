@@ -25,6 +25,12 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "ScannerAPI.h"
+#include "SolverAPI.h"
+#include "CAsyncSolver.h"
+#include "CReadingSolver.h"
+#include "CStreamingSolver.h"
+#include "CTreeEstimator.h"
+#include <future>
 
 //////////////////////////////////////////////////////////////////////////
 /**
@@ -35,7 +41,8 @@
 
 class CHexadokuSolverDlg :  public CDialogEx,
               public IScannerObserver,
-              public IImageObserver
+              public IImageObserver,
+              public ISolveObserver
 {
 public:
   CHexadokuSolverDlg(CWnd* pParent = NULL);
@@ -56,12 +63,35 @@ protected:
   IScanner*      m_Scanner;
 
   CComboBox*      m_Combobox;
+
+  IGridRecognizer*  m_Recognizer;
+  ISolver*          m_Solver;
+  ISolver*          m_Parallel;                // for the scans with a big search tree
+  IVerifier*        m_Verifier;
+  IGrader*          m_Grader;
+  IPuzzleCache*     m_Cache;
+
+  Sudoku::CStreamingSolver m_Streaming;
+  Sudoku::CReadingSolver   m_Reading;
+  Sudoku::CTreeEstimator   m_Estimator;
+  Sudoku::CAsyncSolver     m_Async;     // after the backends it uses, so its solve ends first
+
+  std::shared_future<CSolveResult> m_Result;  // of the solve running in the background
+  CGrid             m_Givens;                 // of the scan being solved
+  CReading          m_Glyphs;                 // all guesses of the recognizer for the scan being solved
+  bool              m_hasGlyphs;
+  bool              m_isResolving;            // the solve running picks the givens among the guesses
+  bool              m_isRunaway;              // the givens read were estimated to search far too long
+  CGrid             m_Layout;                 // regions of the jigsaw or diagonal variant picked by the operator
+  bool              m_hasLayout;
+  CString           m_StatsFolder;            // the statistics of every solve are written into, none if empty
   
 
   // Generierte Funktionen fr die Meldungstabellen
   virtual BOOL OnInitDialog();
   afx_msg void OnSysCommand(UINT nID, LPARAM lParam);
   afx_msg LRESULT OnUserMessage(WPARAM wParam, LPARAM lParam);
+  afx_msg LRESULT OnSolveMessage(WPARAM wParam, LPARAM lParam);
   afx_msg void OnPaint();
   afx_msg HCURSOR OnQueryDragIcon();
 
@@ -73,6 +103,7 @@ protected:
 
 public:
   afx_msg void OnBnClickedButtonStart();
+  afx_msg void OnBnClickedButtonLayout();
   afx_msg void OnCbnSelchangeDevice();
 
   //////////////////////////////////////////////////////////////////////////
@@ -81,8 +112,31 @@ public:
 
   virtual void OnImageEvent(const IImage & img) const;
 
+  virtual void OnSolveEvent(const CSolveResult & result) const;
+
   void SelectDevice(int id);
 
+  //! sets the stage extracting the givens from the scanned images
+  void SetRecognizer(IGridRecognizer* recognizer);
+
+  //! selects the solver backend used for the scanned Sudokus
+  void SelectSolver(ISolverFactory::Backend backend);
+
+  //! recognizes the Sudoku of a downloaded document and starts to solve it in the background
+  void SolveDocument(::IDocument & doc);
+
+  //! shows the outcome of a solve, back on the thread of the dialog
+  void FinishSolve(const CSolveResult & result);
+
+  //! starts to pick the givens of the scan among the guesses of the recognizer in the background
+  void StartResolve();
+
+  //! shows the solution of a Sudoku along with its difficulty
+  void ShowSolution(const CGrid & grid, IGrader::Grade grade);
+
+  //! shows a grid below a line of text
+  void ShowGrid(const CString & text, const CGrid & grid);
+
   void Cleanup();
   
 };
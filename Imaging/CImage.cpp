@@ -29,7 +29,8 @@ WIA2::CImage::CImage()
     m_MemDC(NULL),
     m_Bitmap(NULL),
     m_BitmapData(NULL),
-    m_Size(0U)
+    m_Size(0U),
+    m_Received(0U)
 {
 }
 
@@ -89,6 +90,7 @@ bool WIA2::CImage::Init( const LPBITMAPINFO info, unsigned long size )
     
 
     m_Size = size;
+    m_Received = 0U;
 
     memcpy(&m_BitmapInfo, info, sizeof(BITMAPINFO));
 
@@ -128,6 +130,7 @@ bool WIA2::CImage::Cleanup()
     
     m_BitmapData = NULL;
     m_Size = 0U;
+    m_Received = 0U;
 
     m_Initialized = false;
     return true;
@@ -163,6 +166,43 @@ bool WIA2::CImage::GetRawData( unsigned char** buffer, unsigned long* size ) con
 }
 
 
+unsigned long WIA2::CImage::GetHeight() const
+{
+  if(!m_Initialized)
+  {
+    return 0U;
+  }
+
+  return (unsigned long) abs(m_BitmapInfo.bmiHeader.biHeight);
+}
+
+
+void WIA2::CImage::GetReceivedRows( unsigned long* top, unsigned long* bottom ) const
+{
+  const unsigned long height = GetHeight();
+  const unsigned long stride = ((m_BitmapInfo.bmiHeader.biWidth * m_BitmapInfo.bmiHeader.biBitCount + 31) / 32) * 4;
+  unsigned long rows = (0 != stride) ? m_Received / stride : 0U;
+
+  if(rows > height)
+  {
+    rows = height;
+  }
+
+  // bottom-up bitmaps are streamed starting with their last scanline
+  const bool bottomUp = m_BitmapInfo.bmiHeader.biHeight > 0;
+
+  if(NULL != top)
+  {
+    *top = bottomUp ? height - rows : 0U;
+  }
+
+  if(NULL != bottom)
+  {
+    *bottom = bottomUp ? height : rows;
+  }
+}
+
+
 void WIA2::CImage::Update() const
 {
   // notify the observers about this update
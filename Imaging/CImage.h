@@ -45,6 +45,7 @@ class CImage : public IImage
   HBITMAP               m_Bitmap;
   volatile unsigned char*      m_BitmapData; // content is volatile, pointer address not 
   unsigned long         m_Size;
+  volatile unsigned long m_Received; // bytes of the bitmap data streamed so far
   bool                  m_Initialized;
   CRITICAL_SECTION      m_Sync;
   BITMAPINFO            m_BitmapInfo;
@@ -95,6 +96,12 @@ public:
   //! saves the image 
   virtual void Save( const wchar_t* path) const;
 
+  //! the height of the image in scanlines
+  virtual unsigned long GetHeight() const;
+
+  //! the scanlines received so far, counted from the top of the image
+  virtual void GetReceivedRows(unsigned long* top, unsigned long* bottom) const;
+
 };
 
 
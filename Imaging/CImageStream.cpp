@@ -179,6 +179,7 @@ HRESULT __stdcall CImageStream::Write( const void* buffer, ULONG bufSize, ULONG*
     
     m_Image->Lock();
     std::copy<const unsigned char*, volatile unsigned char* volatile >( pbuf, pbuf + bufSize, m_StreamPosition);
+    m_Image->m_Received += bufSize;
     m_Image->Unlock();
 
     m_Image->Update();
@@ -198,6 +198,12 @@ public:
 
   //! gets access to the raw data buffer
   virtual bool GetRawData(unsigned char** buffer, unsigned long* size) const = 0; 
+
+  //! the height of the image in scanlines
+  virtual unsigned long GetHeight() const = 0;
+
+  //! the scanlines received so far, counted from the top of the image
+  virtual void GetReceivedRows(unsigned long* top, unsigned long* bottom) const = 0;
 };
 
 
@@ -0,0 +1,151 @@
+#ifndef BitOps_h__
+#define BitOps_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     BitOps.h
+  \brief    Bit manipulation helpers for the candidate masks.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// MSVC compiles AVX2 intrinsics without /arch, gcc and clang need to be told per function
+#if defined(__GNUC__)
+#define SUDOKU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SUDOKU_TARGET_AVX2
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+//! number of set bits
+inline unsigned int PopCount(uint32_t v)
+{
+#ifdef _MSC_VER
+  return __popcnt(v);
+#else
+  return __builtin_popcount(v);
+#endif
+}
+
+//! index of the lowest set bit, v must not be zero
+inline unsigned int LowestBit(uint32_t v)
+{
+#ifdef _MSC_VER
+  unsigned long idx = 0;
+  _BitScanForward(&idx, v);
+  return idx;
+#else
+  return __builtin_ctz(v);
+#endif
+}
+
+//! true if exactly one bit is set
+inline bool isSingle(uint32_t v)
+{
+  return 0 != v && 0 == (v & (v - 1));
+}
+
+//! number of set bits of a 64 bit mask
+inline unsigned int PopCount(uint64_t v)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  return static_cast<unsigned int>(__popcnt64(v));
+#elif defined(_MSC_VER)
+  return __popcnt(static_cast<uint32_t>(v)) + __popcnt(static_cast<uint32_t>(v >> 32));
+#else
+  return __builtin_popcountll(v);
+#endif
+}
+
+//! index of the lowest set bit of a 64 bit mask, v must not be zero
+inline unsigned int LowestBit(uint64_t v)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long idx = 0;
+  _BitScanForward64(&idx, v);
+  return idx;
+#elif defined(_MSC_VER)
+  return 0 != static_cast<uint32_t>(v) ? LowestBit(static_cast<uint32_t>(v)) : 32 + LowestBit(static_cast<uint32_t>(v >> 32));
+#else
+  return __builtin_ctzll(v);
+#endif
+}
+
+//! true if exactly one bit of a 64 bit mask is set
+inline bool isSingle(uint64_t v)
+{
+  return 0 != v && 0 == (v & (v - 1));
+}
+
+// the masks of grids up to 16x16 would otherwise fit both widths equally well
+inline unsigned int PopCount(uint16_t v) { return PopCount(static_cast<uint32_t>(v)); }
+inline unsigned int LowestBit(uint16_t v) { return LowestBit(static_cast<uint32_t>(v)); }
+inline bool isSingle(uint16_t v) { return isSingle(static_cast<uint32_t>(v)); }
+
+//! checks processor and operating system support of AVX2
+inline bool DetectAvx2()
+{
+#if defined(_MSC_VER)
+  int info[4] = {0};
+
+  __cpuid(info, 0);
+
+  if(info[0] < 7)
+  {
+    return false;
+  }
+
+  __cpuid(info, 1);
+
+  const bool osxsave = 0 != (info[2] & (1 << 27));
+  const bool avx = 0 != (info[2] & (1 << 28));
+
+  if(!osxsave || !avx || 6 != (_xgetbv(0) & 6))
+  {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+
+  return 0 != (info[1] & (1 << 5));
+#elif defined(__GNUC__)
+  return 0 != __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // BitOps_h__
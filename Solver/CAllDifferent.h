@@ -0,0 +1,311 @@
+#ifndef CAllDifferent_h__
+#define CAllDifferent_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CAllDifferent.h
+  \brief    All-different propagation by bipartite matching for Sudokus of box order 3 to 6.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverTraits.h"
+#include "BitOps.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CAllDifferent
+  \brief    Removes every candidate that fits no assignment of a whole unit.
+
+  Each unit is a bipartite graph of its cells and digits, one edge per
+  candidate. A candidate can only be part of a solution if some perfect
+  matching of that graph uses it (Regin): it is either matched itself, or
+  its cell and the cell matched to its digit lie on a common alternating
+  cycle. The cycles are found as the strongly connected components of the
+  graph in which each matched digit points to the other candidates of its
+  cell, each one found on bitmasks as the digits reached both forward and
+  backward from one digit. This subsumes naked and hidden subsets of any
+  size within a unit.
+
+  The matching of every unit is kept between calls. A call only drops the
+  pairs whose candidate has gone and rematches their cells by augmenting
+  paths, so a search node changing a few cells costs a few short paths
+  per unit instead of a matching from scratch. The kept pairs are merely
+  a starting point, so the search does not have to take them back. The
+  candidates of each unit are kept as well, after pruning, and a unit
+  whose candidates are still the same has nothing to remove and is not
+  looked at again.
+
+  Filled cells hold their digit as their only candidate and are matched
+  like any other cell. No matching means a digit has too few cells left,
+  which is a contradiction.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CAllDifferent
+{
+public:
+  typedef CGridTraits<Order>        Traits;
+  typedef typename Traits::Mask     Mask;
+  typedef typename Traits::Tables   Tables;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells,
+    Units = Traits::Units
+  };
+
+  CAllDifferent();
+
+  //! removes the candidates no matching of their units uses, false if a unit has no matching
+  bool Propagate(const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed);
+
+  //! forgets the matchings, they are rebuilt by the next call
+  void Clear();
+
+private:
+  //! matches one unit, prunes it and returns false if it cannot be matched
+  bool Propagate(const Tables & tables, unsigned int unit, Mask* candidates, const unsigned char* values, bool & changed);
+
+  //! the digits reached from the lowest of the digits along the edges, without leaving them
+  static Mask Reach(const Mask* edges, Mask digits);
+
+  //! finds a digit for the cell at the position, rematching others along an alternating path
+  bool Augment(const Mask* masks, unsigned char* match, unsigned char* owner, unsigned int pos, Mask & visited);
+
+  unsigned char m_Match[Units][Size];   // the digit matched to each position, Size = none
+  unsigned char m_Owner[Units][Size];   // the position matched to each digit, Size = none
+  Mask          m_Pruned[Units][Size];  // the candidates of each unit after the last pruning
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CAllDifferent implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CAllDifferent<Order>::CAllDifferent()
+{
+  Clear();
+}
+
+template <unsigned int Order>
+void CAllDifferent<Order>::Clear()
+{
+  for(unsigned int unit=0; unit<Units; ++unit)
+  {
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      m_Match[unit][i] = Size;
+      m_Owner[unit][i] = Size;
+      m_Pruned[unit][i] = 0;
+    }
+  }
+}
+
+template <unsigned int Order>
+bool CAllDifferent<Order>::Propagate( const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed )
+{
+  changed = false;
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    if(!Propagate(tables, unit, candidates, values, changed))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CAllDifferent<Order>::Propagate( const Tables & tables, unsigned int unit, Mask* candidates, const unsigned char* values, bool & changed )
+{
+  const unsigned short* const cells = tables.m_Units[unit];
+  unsigned char* const match = m_Match[unit];
+  unsigned char* const owner = m_Owner[unit];
+  Mask* const masks = m_Pruned[unit];
+  Mask open = 0;
+  bool same = true;
+
+  for(unsigned int pos=0; pos<Size; ++pos)
+  {
+    const unsigned int cell = cells[pos];
+    same = same && masks[pos] == candidates[cell];
+    masks[pos] = candidates[cell];
+
+    if(0 == values[cell])
+    {
+      open |= static_cast<Mask>(Mask(1) << pos);
+    }
+
+    // the pair is gone if its candidate is
+    const unsigned int digit = match[pos];
+
+    if(digit < Size && 0 == (masks[pos] & (Mask(1) << digit)))
+    {
+      match[pos] = Size;
+      owner[digit] = Size;
+    }
+  }
+
+  // pruning again would not remove anything, a filled unit has nothing left to remove
+  if(same || 0 == open)
+  {
+    return true;
+  }
+
+  for(unsigned int pos=0; pos<Size; ++pos)
+  {
+    if(Size == match[pos])
+    {
+      Mask visited = 0;
+
+      if(!Augment(masks, match, owner, pos, visited))
+      {
+        masks[0] = 0;   // looks changed to the next call
+        return false;
+      }
+    }
+  }
+
+  // each digit points to the digits its cell could take instead, and back
+  Mask next[Size];
+  Mask prev[Size];
+  Mask digits = 0;
+
+  for(unsigned int digit=0; digit<Size; ++digit)
+  {
+    prev[digit] = 0;
+  }
+
+  for(unsigned int pos=0; pos<Size; ++pos)
+  {
+    if(open & (Mask(1) << pos))
+    {
+      const unsigned int digit = match[pos];
+      const Mask bit = static_cast<Mask>(Mask(1) << digit);
+
+      next[digit] = masks[pos];
+      digits |= bit;
+
+      for(Mask others = masks[pos]; 0 != others; others &= others - 1)
+      {
+        prev[LowestBit(others)] |= bit;
+      }
+    }
+  }
+
+  // a candidate stays if its digit and the matched one share a component
+  while(0 != digits)
+  {
+    const Mask component = Reach(next, digits) & Reach(prev, digits);
+
+    digits &= ~component;
+
+    for(Mask members = component; 0 != members; members &= members - 1)
+    {
+      const unsigned int pos = owner[LowestBit(members)];
+      const Mask removed = masks[pos] & ~component;
+
+      if(0 != removed)
+      {
+        masks[pos] &= ~removed;
+        candidates[cells[pos]] = masks[pos];
+        changed = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+typename CAllDifferent<Order>::Mask CAllDifferent<Order>::Reach( const Mask* edges, Mask digits )
+{
+  // from the lowest digit left, within the digits left
+  Mask reached = static_cast<Mask>(digits & (~digits + 1));
+  Mask frontier = reached;
+
+  while(0 != frontier)
+  {
+    Mask found = 0;
+
+    for(; 0 != frontier; frontier &= frontier - 1)
+    {
+      found |= edges[LowestBit(frontier)];
+    }
+
+    frontier = found & digits & ~reached;
+    reached |= frontier;
+  }
+
+  return reached;
+}
+
+template <unsigned int Order>
+bool CAllDifferent<Order>::Augment( const Mask* masks, unsigned char* match, unsigned char* owner, unsigned int pos, Mask & visited )
+{
+  Mask digits = masks[pos] & ~visited;
+
+  // a free digit ends the path at once
+  for(Mask free = digits; 0 != free; free &= free - 1)
+  {
+    const unsigned int digit = LowestBit(free);
+
+    if(Size == owner[digit])
+    {
+      match[pos] = static_cast<unsigned char>(digit);
+      owner[digit] = static_cast<unsigned char>(pos);
+      return true;
+    }
+  }
+
+  visited |= digits;
+
+  while(0 != digits)
+  {
+    const unsigned int digit = LowestBit(digits);
+    digits &= digits - 1;
+
+    if(Augment(masks, match, owner, owner[digit], visited))
+    {
+      match[pos] = static_cast<unsigned char>(digit);
+      owner[digit] = static_cast<unsigned char>(pos);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CAllDifferent_h__
@@ -0,0 +1,297 @@
+#include "stdafx.h"
+#include "CAsyncSolver.h"
+#include "CReadingSolver.h"
+#include "CTreeEstimator.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CAsyncSolver.cpp
+  \brief    Solves a grid on a thread of its own, within a deadline and cancellable.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CCancelToken::CCancelToken()
+  : m_Flag(std::make_shared<std::atomic<bool> >(false))
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CAsyncSolver::CAsyncSolver()
+  : m_Solver(NULL),
+    m_Verifier(NULL),
+    m_Reading(NULL),
+    m_Estimator(NULL),
+    m_Parallel(NULL),
+    m_Grid(),
+    m_Glyphs(),
+    m_hasGlyphs(false),
+    m_Millis(0UL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Token(),
+    m_Observer(NULL),
+    m_Promise(),
+    m_Thread()
+{
+}
+
+CAsyncSolver::~CAsyncSolver()
+{
+  Cancel();
+  Wait();
+}
+
+void CAsyncSolver::Use( ISolver* solver, IVerifier* verifier, CReadingSolver* reading )
+{
+  Cancel();
+  Wait();
+
+  m_Solver = solver;
+  m_Verifier = verifier;
+  m_Reading = reading;
+}
+
+void CAsyncSolver::UseEstimator( CTreeEstimator* estimator, ISolver* parallel )
+{
+  Cancel();
+  Wait();
+
+  m_Estimator = estimator;
+  m_Parallel = parallel;
+}
+
+std::shared_future<CSolveResult> CAsyncSolver::Start( const CGrid & grid, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer )
+{
+  Cancel();
+  Wait();
+
+  m_hasGlyphs = false;
+
+  return Launch(grid, millis, token, observer);
+}
+
+std::shared_future<CSolveResult> CAsyncSolver::Start( const CGrid & grid, const CReading & reading, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer )
+{
+  Cancel();
+  Wait();
+
+  m_Glyphs = reading;
+  m_hasGlyphs = true;
+
+  return Launch(grid, millis, token, observer);
+}
+
+std::shared_future<CSolveResult> CAsyncSolver::Launch( const CGrid & grid, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer )
+{
+  m_Grid = grid;
+  m_Millis = millis;
+  m_Deadline = 0UL != millis ? std::chrono::steady_clock::now() + std::chrono::milliseconds(millis) : std::chrono::steady_clock::time_point::max();
+  m_Token = token;
+  m_Observer = observer;
+  m_Promise = std::promise<CSolveResult>();
+
+  std::shared_future<CSolveResult> result = m_Promise.get_future().share();
+
+  m_Thread = std::thread(&CAsyncSolver::Run, this);
+
+  return result;
+}
+
+void CAsyncSolver::Cancel()
+{
+  m_Token.Cancel();
+}
+
+void CAsyncSolver::Wait()
+{
+  if(m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+void CAsyncSolver::Run()
+{
+  CSolveResult result;
+  ISolver* solver = m_Solver;
+
+  result.m_Grid = m_Grid;
+
+  if(m_hasGlyphs)
+  {
+    Resolve(result);
+  }
+  else if(Schedule(result, solver))
+  {
+    Solve(result, solver);
+  }
+
+  // the future is ready by the time the observer hears of it
+  m_Promise.set_value(result);
+
+  if(NULL != m_Observer)
+  {
+    m_Observer->OnSolveEvent(result);
+  }
+}
+
+bool CAsyncSolver::Schedule( CSolveResult & result, ISolver* & solver )
+{
+  if(NULL == m_Estimator)
+  {
+    return true;
+  }
+
+  m_Estimator->SetLimits(m_Token.Flag(), m_Deadline);
+
+  const bool estimated = m_Estimator->Estimate(m_Grid);
+
+  m_Estimator->SetLimits(NULL, std::chrono::steady_clock::time_point::max());
+
+  if(m_Estimator->isStopped())
+  {
+    result.m_Status = m_Token.isCancelled() ? CSolveResult::Cancelled : CSolveResult::TimedOut;
+    return false;
+  }
+
+  // an order it does not know or givens it finds contradicting are up to the verifier
+  if(!estimated)
+  {
+    return true;
+  }
+
+  if(0UL != m_Millis && m_Estimator->isRunaway(m_Millis))
+  {
+    result.m_Status = CSolveResult::Runaway;
+    return false;
+  }
+
+  // the threads of the parallel backend only pay off on a big search tree
+  if(ISolverFactory::Parallel == m_Estimator->Backend() && NULL != m_Parallel)
+  {
+    solver = m_Parallel;
+  }
+
+  // the deadline still counts from the start, the estimate took part of it
+  if(0UL != m_Millis)
+  {
+    m_Deadline -= std::chrono::milliseconds(m_Millis - m_Estimator->Deadline(m_Millis));
+  }
+
+  return true;
+}
+
+void CAsyncSolver::Solve( CSolveResult & result, ISolver* solver )
+{
+  if(NULL == solver || NULL == m_Verifier || !solver->Supports(m_Grid.Order()))
+  {
+    result.m_Status = CSolveResult::Contradictory;
+    return;
+  }
+
+  m_Verifier->SetLimits(m_Token.Flag(), m_Deadline);
+  solver->SetLimits(m_Token.Flag(), m_Deadline);
+
+  switch(m_Verifier->Verify(m_Grid))
+  {
+  case IVerifier::Contradictory:
+    result.m_Status = CSolveResult::Contradictory;
+    break;
+
+  case IVerifier::Ambiguous:
+    result.m_Status = CSolveResult::Ambiguous;
+    break;
+
+  case IVerifier::Undecided:
+    result.m_Status = m_Token.isCancelled() ? CSolveResult::Cancelled : CSolveResult::TimedOut;
+    result.m_Grid = m_Verifier->Solution();
+    break;
+
+  default:
+    if(solver->Solve(result.m_Grid))
+    {
+      result.m_Status = CSolveResult::Solved;
+    }
+    else if(solver->isStopped())
+    {
+      result.m_Status = m_Token.isCancelled() ? CSolveResult::Cancelled : CSolveResult::TimedOut;
+      solver->Partial(result.m_Grid);
+    }
+    else
+    {
+      result.m_Status = CSolveResult::Contradictory;
+    }
+
+    result.m_Stats = solver->Stats();
+    break;
+  }
+
+  m_Verifier->SetLimits(NULL, std::chrono::steady_clock::time_point::max());
+  solver->SetLimits(NULL, std::chrono::steady_clock::time_point::max());
+}
+
+void CAsyncSolver::Resolve( CSolveResult & result )
+{
+  if(NULL == m_Reading)
+  {
+    result.m_Status = CSolveResult::Contradictory;
+    return;
+  }
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  result.m_Givens = m_Grid;
+
+  m_Reading->SetLimits(m_Token.Flag(), m_Deadline);
+
+  switch(m_Reading->Resolve(m_Glyphs, result.m_Givens, result.m_Grid))
+  {
+  case IVerifier::Unique:
+    result.m_Status = CSolveResult::Solved;
+    break;
+
+  case IVerifier::Ambiguous:
+    result.m_Status = CSolveResult::Ambiguous;
+    break;
+
+  case IVerifier::Undecided:
+    result.m_Status = m_Token.isCancelled() ? CSolveResult::Cancelled : CSolveResult::TimedOut;
+    break;
+
+  default:
+    result.m_Status = CSolveResult::Contradictory;
+    break;
+  }
+
+  m_Reading->SetLimits(NULL, std::chrono::steady_clock::time_point::max());
+
+  // the search that proved the solution unique is all there is to report
+  result.m_Stats.m_Backend = L"Guesses of the recognizer";
+  result.m_Stats.m_Micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
@@ -0,0 +1,163 @@
+#ifndef CAsyncSolver_h__
+#define CAsyncSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CAsyncSolver.h
+  \brief    Solves a grid on a thread of its own, within a deadline and cancellable.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+class CReadingSolver;
+class CTreeEstimator;
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CCancelToken
+  \brief    Shared flag telling a solve in the background to give up.
+
+  Copies share the flag, so the caller keeps one copy and hands the other
+  to CAsyncSolver::Start(). A fresh token is needed for every solve.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CCancelToken
+{
+public:
+  CCancelToken();
+
+  //! asks the solve holding a copy of this token to stop
+  void Cancel() const { m_Flag->store(true); }
+
+  //! whether Cancel() was called on any copy
+  bool isCancelled() const { return m_Flag->load(); }
+
+  //! the flag the solvers poll
+  const std::atomic<bool>* Flag() const { return m_Flag.get(); }
+
+private:
+  std::shared_ptr<std::atomic<bool> > m_Flag;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CAsyncSolver
+  \brief    Verifies and solves one grid at a time off the caller's thread.
+
+  Start() returns at once with a future of the CSolveResult and, if an
+  observer is given, tells it about the result on the solving thread once
+  the future is ready. The verifier and solver poll the token and the deadline every few
+  hundred nodes, so a hostile or misread grid ends as TimedOut or Cancelled
+  after a few milliseconds more, with the fullest state the search reached
+  as the grid of the result. Starting a new solve cancels the running one
+  and waits for it to end.
+
+  With an estimator, the size of the search tree is probed first, within
+  the same limits. A tree estimated to run far past the deadline is not
+  searched at all, a big one goes to the parallel backend, and an easy
+  grid is given up sooner.
+
+  Givens read wrong are picked anew among the guesses of the recognizer
+  the same way, within the deadline and cancellable, and the result
+  holds the givens picked besides their solution.
+
+  The backends are not owned and must outlive the solve; Use() and the
+  destructor wait for a running solve to end.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CAsyncSolver
+{
+public:
+  CAsyncSolver();
+  CAsyncSolver(const CAsyncSolver &); // not impl.
+  ~CAsyncSolver();
+
+  //! the backends for the next solves, cancels a running one
+  void Use(ISolver* solver, IVerifier* verifier, CReadingSolver* reading = NULL);
+
+  //! estimates each grid before it is solved, big trees go to the parallel backend; cancels a running solve
+  void UseEstimator(CTreeEstimator* estimator, ISolver* parallel);
+
+  //! starts to solve the grid, gives up after the milliseconds (0 for no limit) or on cancellation
+  std::shared_future<CSolveResult> Start(const CGrid & grid, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer = NULL);
+
+  //! starts to pick the givens among the guesses of the reading instead, the grid gives the layout
+  std::shared_future<CSolveResult> Start(const CGrid & grid, const CReading & reading, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer = NULL);
+
+  //! cancels the running solve, if any
+  void Cancel();
+
+  //! waits for the running solve to end
+  void Wait();
+
+private:
+  //! starts the solving thread, the last solve has ended
+  std::shared_future<CSolveResult> Launch(const CGrid & grid, unsigned long millis, const CCancelToken & token, const ISolveObserver* observer);
+
+  //! the solving thread
+  void Run();
+
+  //! estimates the grid, picks the backend and deadline, false if the outcome is known without a search
+  bool Schedule(CSolveResult & result, ISolver* & solver);
+
+  //! verifies and solves the grid with the backend
+  void Solve(CSolveResult & result, ISolver* solver);
+
+  //! picks the givens among the guesses of the reading, on the solving thread
+  void Resolve(CSolveResult & result);
+
+  ISolver*                              m_Solver;
+  IVerifier*                            m_Verifier;
+  CReadingSolver*                       m_Reading;
+  CTreeEstimator*                       m_Estimator;
+  ISolver*                              m_Parallel;
+  CGrid                                 m_Grid;
+  CReading                              m_Glyphs;     // of the reading to pick the givens from
+  bool                                  m_hasGlyphs;
+  unsigned long                         m_Millis;     // the limit of the solve, 0 for none
+  std::chrono::steady_clock::time_point m_Deadline;
+  CCancelToken                          m_Token;
+  const ISolveObserver*                 m_Observer;
+  std::promise<CSolveResult>            m_Promise;
+  std::thread                           m_Thread;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CAsyncSolver_h__
@@ -0,0 +1,535 @@
+#include "stdafx.h"
+#include "CBatchSolver.h"
+#include "CSolverFactory.h"
+#include "CGridValidator.h"
+#include "CStatsWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CBatchSolver.cpp
+  \brief    Solves puzzle files line by line on a pool of threads.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//! the box order of a puzzle line, 0 if the length fits none
+unsigned int OrderOf( size_t length )
+{
+  for(unsigned int order=CGrid::MinOrder; order<=CGrid::MaxOrder; ++order)
+  {
+    if(length == order * order * order * order)
+    {
+      return order;
+    }
+  }
+
+  return 0;
+}
+
+//! the time in microseconds from the given point until now
+double MicrosSince( const Clock::time_point & start )
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+//! the value below which the given fraction of the sorted values lies
+double Percentile( const std::vector<double> & sorted, double fraction )
+{
+  const size_t idx = static_cast<size_t>(fraction * sorted.size());
+
+  return sorted[idx < sorted.size() ? idx : sorted.size() - 1];
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+// CBatchReport
+//////////////////////////////////////////////////////////////////////////
+
+CBatchReport::CBatchReport()
+  : m_Puzzles(0UL),
+    m_Solved(0UL),
+    m_Unsolvable(0UL),
+    m_TimedOut(0UL),
+    m_Invalid(0UL),
+    m_Threads(0),
+    m_Seconds(0.0),
+    m_Mean(0.0),
+    m_Min(0.0),
+    m_Median(0.0),
+    m_P90(0.0),
+    m_P99(0.0),
+    m_P999(0.0),
+    m_Max(0.0)
+{
+}
+
+double CBatchReport::PuzzlesPerSecond() const
+{
+  return m_Seconds > 0.0 ? m_Solved / m_Seconds : 0.0;
+}
+
+std::wstring CBatchReport::ToString() const
+{
+  std::wostringstream str;
+
+  str << std::fixed << std::setprecision(1);
+  str << L"puzzles " << m_Puzzles << L" (solved " << m_Solved << L", unsolvable " << m_Unsolvable
+      << L", timed out " << m_TimedOut << L", invalid " << m_Invalid << L")\n";
+  str << L"threads " << m_Threads << L", " << std::setprecision(3) << m_Seconds << L" s, "
+      << std::setprecision(1) << PuzzlesPerSecond() << L" puzzles/s\n";
+  str << L"latency [us] mean " << m_Mean << L", min " << m_Min << L", median " << m_Median
+      << L", 90% " << m_P90 << L", 99% " << m_P99 << L", 99.9% " << m_P999 << L", max " << m_Max << L"\n";
+
+  return str.str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CBatchSolver
+//////////////////////////////////////////////////////////////////////////
+
+CBatchSolver::CBatchSolver( ISolverFactory::Backend backend, unsigned int threads )
+  : m_Backend(backend),
+    m_ThreadCount(0 != threads ? threads : std::thread::hardware_concurrency()),
+    m_Solvers(),
+    m_Threads(),
+    m_Jobs(),
+    m_Latencies(),
+    m_Next(0),
+    m_Sync(),
+    m_Wake(),
+    m_Idle(),
+    m_Generation(0UL),
+    m_Busy(0),
+    m_Stop(false),
+    m_Layout(),
+    m_TimeLimit(0UL),
+    m_Lockstep(false),
+    m_Report()
+{
+  if(0 == m_ThreadCount)
+  {
+    m_ThreadCount = 1;
+  }
+
+  const ISolverFactory & factory = CSolverFactory::Instance();
+
+  for(unsigned int i=0; i<m_ThreadCount; ++i)
+  {
+    m_Solvers.push_back(factory.Create(m_Backend));
+  }
+
+  m_Jobs.reserve(ChunkSize);
+}
+
+CBatchSolver::~CBatchSolver()
+{
+  const ISolverFactory & factory = CSolverFactory::Instance();
+
+  for(size_t i=0; i<m_Solvers.size(); ++i)
+  {
+    factory.Recycle(m_Solvers[i]);
+  }
+}
+
+bool CBatchSolver::Run( std::istream & input, std::ostream & output, std::ostream* stats )
+{
+  const Clock::time_point start = Clock::now();
+
+  m_Report = CBatchReport();
+  m_Report.m_Threads = m_ThreadCount;
+  m_Latencies.clear();
+  m_Generation = 0UL;
+  m_Busy = 0;
+  m_Stop = false;
+
+  for(unsigned int i=0; i<m_ThreadCount; ++i)
+  {
+    m_Threads.push_back(std::thread(&CBatchSolver::Work, this, i));
+  }
+
+  std::string line;
+
+  for(;;)
+  {
+    m_Jobs.clear();
+
+    while(m_Jobs.size() < ChunkSize && std::getline(input, line))
+    {
+      // tolerate CR LF files and trailing blanks
+      const size_t end = line.find_last_not_of(" \t\r");
+
+      if(std::string::npos == end)
+      {
+        continue;
+      }
+
+      m_Jobs.push_back(CJob());
+      m_Jobs.back().m_Line.assign(line, 0, end + 1);
+    }
+
+    if(m_Jobs.empty())
+    {
+      break;
+    }
+
+    Dispatch();
+
+    for(size_t i=0; i<m_Jobs.size(); ++i)
+    {
+      const CJob & job = m_Jobs[i];
+
+      Write(job, output);
+
+      if(NULL != stats)
+      {
+        if(job.m_Valid)
+        {
+          CStatsWriter::Write(job.m_Stats, *stats);
+        }
+        else
+        {
+          *stats << "{}\n";
+        }
+      }
+
+      if(!job.m_Valid)
+      {
+        ++m_Report.m_Invalid;
+        continue;
+      }
+
+      if(job.m_Solved)
+      {
+        ++m_Report.m_Solved;
+      }
+      else if(job.m_TimedOut)
+      {
+        ++m_Report.m_TimedOut;
+      }
+      else
+      {
+        ++m_Report.m_Unsolvable;
+      }
+
+      ++m_Report.m_Puzzles;
+      m_Latencies.push_back(job.m_Micros);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Sync);
+    m_Stop = true;
+  }
+
+  m_Wake.notify_all();
+
+  for(size_t i=0; i<m_Threads.size(); ++i)
+  {
+    m_Threads[i].join();
+  }
+
+  m_Threads.clear();
+
+  m_Report.m_Seconds = MicrosSince(start) * 1e-6;
+  Summarize();
+
+  output.flush();
+
+  if(NULL != stats)
+  {
+    stats->flush();
+  }
+
+  return !input.bad() && !output.fail() && (NULL == stats || !stats->fail());
+}
+
+void CBatchSolver::Solve( ISolver & solver, CJob & job ) const
+{
+  if(Parse(solver, job))
+  {
+    Search(solver, job);
+  }
+}
+
+void CBatchSolver::SolveBlock( ISolver & solver, CLockstepSolver & lockstep, size_t first, size_t last )
+{
+  CJob* lanes[BlockSize];
+  unsigned int count = 0;
+
+  for(size_t idx=first; idx<last; ++idx)
+  {
+    CJob & job = m_Jobs[idx];
+
+    if(!Parse(solver, job))
+    {
+      continue;
+    }
+
+    const unsigned int order = job.m_Grid.Order();
+
+    // the lanes of one run share the order and so the layout
+    if(0 != count && (order != lanes[0]->m_Grid.Order() || count == CLockstepSolver::Lanes(order)))
+    {
+      Propagate(solver, lockstep, lanes, count);
+      count = 0;
+    }
+
+    if(0 == CLockstepSolver::Lanes(order))
+    {
+      Search(solver, job);
+      continue;
+    }
+
+    lanes[count++] = &job;
+  }
+
+  Propagate(solver, lockstep, lanes, count);
+}
+
+void CBatchSolver::Propagate( ISolver & solver, CLockstepSolver & lockstep, CJob* const* jobs, unsigned int count ) const
+{
+  if(0 == count)
+  {
+    return;
+  }
+
+  CGrid* grids[BlockSize];
+  IVerifier::Verdict verdicts[BlockSize];
+  bool valid[BlockSize];
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    grids[i] = &jobs[i]->m_Grid;
+  }
+
+  const Clock::time_point start = Clock::now();
+  const unsigned int sweeps = lockstep.Propagate(grids, count, verdicts);
+
+  // the grids the lanes filled are checked apart from them, all in one go
+  CGridValidator::Validate(grids, count, valid);
+
+  // the lanes finish together, each one is charged its share
+  const double share = MicrosSince(start) / count;
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    CJob & job = *jobs[i];
+
+    // a solution the validator rejects is searched again from the givens
+    if(IVerifier::Unique == verdicts[i] && !valid[i])
+    {
+      Parse(solver, job);
+      verdicts[i] = IVerifier::Undecided;
+    }
+
+    if(IVerifier::Undecided == verdicts[i])
+    {
+      // the search goes on from the digits the lane placed
+      Search(solver, job);
+
+      job.m_Micros += share;
+      job.m_Stats.m_Micros += share;
+      continue;
+    }
+
+    job.m_Solved = IVerifier::Unique == verdicts[i];
+    job.m_Micros = share;
+    job.m_Stats.Clear();
+    job.m_Stats.m_Backend = L"Lockstep";
+    job.m_Stats.m_Propagations = sweeps;
+    job.m_Stats.m_Micros = share;
+  }
+}
+
+bool CBatchSolver::Parse( const ISolver & solver, CJob & job ) const
+{
+  const unsigned int order = OrderOf(job.m_Line.size());
+
+  job.m_Valid = 0 != order && solver.Supports(order);
+  job.m_Solved = false;
+  job.m_TimedOut = false;
+  job.m_Micros = 0.0;
+
+  if(!job.m_Valid)
+  {
+    return false;
+  }
+
+  job.m_Grid = CGrid(order);
+
+  if(m_Layout.Order() == order)
+  {
+    job.m_Grid.SetLayout(m_Layout);
+  }
+
+  for(unsigned int i=0; i<job.m_Grid.Cells(); ++i)
+  {
+    job.m_Grid.SetAt(i, job.m_Grid.Value(static_cast<unsigned char>(job.m_Line[i])));
+  }
+
+  return true;
+}
+
+void CBatchSolver::Search( ISolver & solver, CJob & job ) const
+{
+  const Clock::time_point start = Clock::now();
+
+  // a hostile grid must not keep a worker from the rest of the batch
+  solver.SetLimits(NULL, 0UL != m_TimeLimit ? start + std::chrono::milliseconds(m_TimeLimit) : Clock::time_point::max());
+
+  job.m_Solved = solver.Solve(job.m_Grid);
+  job.m_TimedOut = !job.m_Solved && solver.isStopped();
+  job.m_Micros = MicrosSince(start);
+  job.m_Stats = solver.Stats();
+}
+
+void CBatchSolver::Write( const CJob & job, std::ostream & output ) const
+{
+  if(job.m_Valid)
+  {
+    const CGrid & grid = job.m_Grid;
+    std::string str(grid.Cells(), '.');
+
+    for(unsigned int i=0; i<grid.Cells(); ++i)
+    {
+      // the givens again if there is no solution
+      const unsigned int value = job.m_Solved ? grid.At(i) : grid.Value(static_cast<unsigned char>(job.m_Line[i]));
+
+      str[i] = static_cast<char>(grid.Symbol(value));
+    }
+
+    output << str;
+  }
+
+  output << '\n';
+}
+
+void CBatchSolver::Dispatch()
+{
+  std::unique_lock<std::mutex> lock(m_Sync);
+
+  m_Next = 0;
+  m_Busy = m_ThreadCount;
+  ++m_Generation;
+
+  m_Wake.notify_all();
+
+  while(0 != m_Busy)
+  {
+    m_Idle.wait(lock);
+  }
+}
+
+void CBatchSolver::Work( unsigned int index )
+{
+  ISolver & solver = *m_Solvers[index];
+  unsigned long seen = 0UL;
+
+  // about 60 KB of lanes, too much for the stack of a pool thread
+  std::unique_ptr<CLockstepSolver> lockstep(m_Lockstep ? new CLockstepSolver() : NULL);
+
+  for(;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_Sync);
+
+      while(!m_Stop && seen == m_Generation)
+      {
+        m_Wake.wait(lock);
+      }
+
+      if(m_Stop)
+      {
+        return;
+      }
+
+      seen = m_Generation;
+    }
+
+    if(NULL != lockstep.get())
+    {
+      for(size_t first=m_Next.fetch_add(BlockSize); first<m_Jobs.size(); first=m_Next.fetch_add(BlockSize))
+      {
+        SolveBlock(solver, *lockstep, first, std::min<size_t>(first + BlockSize, m_Jobs.size()));
+      }
+    }
+    else
+    {
+      for(size_t idx=m_Next++; idx<m_Jobs.size(); idx=m_Next++)
+      {
+        Solve(solver, m_Jobs[idx]);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_Sync);
+
+    if(0 == --m_Busy)
+    {
+      m_Idle.notify_one();
+    }
+  }
+}
+
+void CBatchSolver::Summarize()
+{
+  if(m_Latencies.empty())
+  {
+    return;
+  }
+
+  std::sort(m_Latencies.begin(), m_Latencies.end());
+
+  double sum = 0.0;
+
+  for(size_t i=0; i<m_Latencies.size(); ++i)
+  {
+    sum += m_Latencies[i];
+  }
+
+  m_Report.m_Mean = sum / m_Latencies.size();
+  m_Report.m_Min = m_Latencies.front();
+  m_Report.m_Median = Percentile(m_Latencies, 0.5);
+  m_Report.m_P90 = Percentile(m_Latencies, 0.9);
+  m_Report.m_P99 = Percentile(m_Latencies, 0.99);
+  m_Report.m_P999 = Percentile(m_Latencies, 0.999);
+  m_Report.m_Max = m_Latencies.back();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
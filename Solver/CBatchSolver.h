@@ -0,0 +1,200 @@
+#ifndef CBatchSolver_h__
+#define CBatchSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CBatchSolver.h
+  \brief    Solves puzzle files line by line on a pool of threads.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "CLockstepSolver.h"
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CBatchReport
+  \brief    Throughput and latency figures of one batch run.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CBatchReport
+{
+public:
+  CBatchReport();
+
+  //! the solved puzzles per second of wall-clock time
+  double PuzzlesPerSecond() const;
+
+  //! a few lines of text for the operator
+  std::wstring ToString() const;
+
+  unsigned long m_Puzzles;      // lines holding a puzzle
+  unsigned long m_Solved;
+  unsigned long m_Unsolvable;
+  unsigned long m_TimedOut;     // given up after the time limit
+  unsigned long m_Invalid;      // lines of a wrong length
+  unsigned int  m_Threads;
+  double        m_Seconds;      // wall-clock time of the whole run
+
+  // solve time per puzzle in microseconds
+  double        m_Mean;
+  double        m_Min;
+  double        m_Median;
+  double        m_P90;
+  double        m_P99;
+  double        m_P999;
+  double        m_Max;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CBatchSolver
+  \brief    Streams puzzles from a file through the solver backends.
+
+  Each line holds one puzzle, 81 symbols for a Sudoku, 256 for a Hexadoku,
+  625 for a 25x25 or 1296 for a 36x36 grid, written like CGrid::Symbol()
+  with '.' or any other unknown symbol for an empty cell. Lines are read
+  in chunks, the puzzles of a chunk are taken one by one by the threads
+  of the pool, each owning a solver created by the same factory the scan
+  pipeline uses, and the chunk is written back in input order before the
+  next one is read.
+
+  A solved puzzle is written as its solution, a puzzle without solution
+  as its givens, a line of a wrong length as an empty line. Empty input
+  lines are skipped. A puzzle still unsolved after SetTimeLimit() is
+  given up and written as its givens as well. If wanted, the CSolveStats
+  of each puzzle are written as one line of JSON per output line, {} for
+  a line of a wrong length.
+  A layout given by SetLayout() applies to every puzzle of its order.
+
+  With UseLockstep() the threads take blocks of puzzles and propagate
+  them together in a CLockstepSolver, the backend only searches the ones
+  propagation leaves open. The time of a block is shared among its lanes.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CBatchSolver
+{
+public:
+  //! uses one thread per hardware thread if no count is given
+  explicit CBatchSolver(ISolverFactory::Backend backend = ISolverFactory::Bitboard, unsigned int threads = 0);
+  CBatchSolver(const CBatchSolver &); // not impl.
+  ~CBatchSolver();
+
+  //! solves all puzzles of the input and writes the results and, if given, their stats in input order
+  bool Run(std::istream & input, std::ostream & output, std::ostream* stats = NULL);
+
+  //! the regions and diagonals for the puzzles of the same order, e.g. from CLayoutReader
+  void SetLayout(const CGrid & layout) { m_Layout = layout; }
+
+  //! gives up a puzzle after the milliseconds, 0 for no limit
+  void SetTimeLimit(unsigned long millis) { m_TimeLimit = millis; }
+
+  //! propagates blocks of puzzles in lockstep first, only the ones left open are searched by the backend
+  void UseLockstep(bool enable) { m_Lockstep = enable; }
+
+  //! the figures of the last call to Run()
+  const CBatchReport & Report() const { return m_Report; }
+
+private:
+  enum
+  {
+    ChunkSize = 4096,   // puzzles read before the pool starts on them
+    BlockSize = 16      // puzzles taken at once by a thread in lockstep, the most lanes of any order
+  };
+
+  //! one line of the input
+  struct CJob
+  {
+    std::string   m_Line;
+    CGrid         m_Grid;
+    bool          m_Valid;
+    bool          m_Solved;
+    bool          m_TimedOut;
+    double        m_Micros;
+    CSolveStats   m_Stats;
+  };
+
+  //! parses and solves one job
+  void Solve(ISolver & solver, CJob & job) const;
+
+  //! parses and solves the jobs of a block, as many as possible in lockstep
+  void SolveBlock(ISolver & solver, CLockstepSolver & lockstep, size_t first, size_t last);
+
+  //! propagates the parsed jobs in lockstep and searches the ones left open
+  void Propagate(ISolver & solver, CLockstepSolver & lockstep, CJob* const* jobs, unsigned int count) const;
+
+  //! the grid of the line of a job, false if the line is no puzzle the backend solves
+  bool Parse(const ISolver & solver, CJob & job) const;
+
+  //! solves the parsed grid of a job with the backend, within the time limit
+  void Search(ISolver & solver, CJob & job) const;
+
+  //! writes the result of one job
+  void Write(const CJob & job, std::ostream & output) const;
+
+  //! lets the pool solve all jobs of the current chunk
+  void Dispatch();
+
+  //! the loop of one pool thread
+  void Work(unsigned int index);
+
+  //! computes the latency figures from the collected times
+  void Summarize();
+
+  ISolverFactory::Backend   m_Backend;
+  unsigned int              m_ThreadCount;
+  std::vector<ISolver*>     m_Solvers;    // one per pool thread
+  std::vector<std::thread>  m_Threads;
+  std::vector<CJob>         m_Jobs;       // the current chunk
+  std::vector<double>       m_Latencies;
+  std::atomic<size_t>       m_Next;       // next job to take
+  std::mutex                m_Sync;
+  std::condition_variable   m_Wake;       // a chunk is ready or the pool stops
+  std::condition_variable   m_Idle;       // the last thread finished the chunk
+  unsigned long             m_Generation; // counts the dispatched chunks
+  unsigned int              m_Busy;       // threads still working on the chunk
+  bool                      m_Stop;
+  CGrid                     m_Layout;
+  unsigned long             m_TimeLimit;  // milliseconds per puzzle, 0 = none
+  bool                      m_Lockstep;
+  CBatchReport              m_Report;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CBatchSolver_h__
@@ -0,0 +1,192 @@
+#include "stdafx.h"
+#include "CBitboardSolver.h"
+#include "CGridValidator.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CBitboardSolver.cpp
+  \brief    Candidate bitmask solver for Sudokus of box order 3 to 6.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! nodes the plain search may spend before learning takes over
+const unsigned long LearningBudget = 2000UL;
+
+CBitboardSolver::Matching s_Matching = CBitboardSolver::MatchFrom25;
+
+//! the plain search first, the learning search for grids that keep it busy,
+//! the partial grid gets the fullest state of the plain search
+template <unsigned int Order>
+bool SolveWith( CBitboardEngine<Order> & engine, CLearningEngine<Order> & learner, CGrid & grid, CSolveStats & stats, CGrid & partial, bool & stopped )
+{
+  engine.ResetStats();
+  engine.SetLimits(NULL, LearningBudget);
+
+  partial = grid;
+
+  const bool solved = engine.Solve(grid);
+
+  engine.SetLimits(NULL, 0UL);
+  engine.Partial(partial);
+  stats.Merge(engine.Stats());
+
+  if(!engine.isAborted() || engine.isStopped())
+  {
+    stopped = engine.isStopped();
+    return solved;
+  }
+
+  const bool learned = learner.Solve(grid);
+
+  stats.m_Nodes += learner.Nodes();
+  stats.m_Backend = L"Bitboard with learning";
+  stopped = learner.isStopped();
+
+  return learned;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CBitboardSolver::CBitboardSolver()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36(),
+    m_Learner9(),
+    m_Learner16(),
+    m_Learner25(),
+    m_Learner36(),
+    m_Stats(),
+    m_Partial(),
+    m_Stopped(false)
+{
+  // matching pays off from 25x25 grids on, smaller ones are searched faster without it
+  m_Engine9.UseMatching(MatchAll == s_Matching);
+  m_Engine16.UseMatching(MatchAll == s_Matching);
+  m_Engine25.UseMatching(MatchNone != s_Matching);
+  m_Engine36.UseMatching(MatchNone != s_Matching);
+}
+
+CBitboardSolver::~CBitboardSolver()
+{
+}
+
+const wchar_t* CBitboardSolver::GetName() const
+{
+  return L"Bitboard";
+}
+
+bool CBitboardSolver::Supports( unsigned int order ) const
+{
+  return order >= 3 && order <= 6;
+}
+
+const CSolveStats & CBitboardSolver::Stats() const
+{
+  return m_Stats;
+}
+
+unsigned long CBitboardSolver::Nodes() const
+{
+  return m_Stats.m_Nodes;
+}
+
+void CBitboardSolver::SetMatching( Matching matching )
+{
+  s_Matching = matching;
+}
+
+void CBitboardSolver::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Engine9.SetDeadline(stop, deadline);
+  m_Engine16.SetDeadline(stop, deadline);
+  m_Engine25.SetDeadline(stop, deadline);
+  m_Engine36.SetDeadline(stop, deadline);
+  m_Learner9.SetDeadline(stop, deadline);
+  m_Learner16.SetDeadline(stop, deadline);
+  m_Learner25.SetDeadline(stop, deadline);
+  m_Learner36.SetDeadline(stop, deadline);
+}
+
+bool CBitboardSolver::isStopped() const
+{
+  return m_Stopped;
+}
+
+void CBitboardSolver::Partial( CGrid & grid ) const
+{
+  grid = m_Partial;
+}
+
+bool CBitboardSolver::Solve( CGrid & grid )
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const CGrid givens(grid);
+  bool solved = false;
+
+  m_Stats.Clear();
+  m_Stats.m_Backend = GetName();
+  m_Partial = grid;
+  m_Stopped = false;
+
+  // the only size decision, everything below runs on compile-time sizes
+  switch(grid.Order())
+  {
+  case 3:
+    solved = SolveWith(m_Engine9, m_Learner9, grid, m_Stats, m_Partial, m_Stopped);
+    break;
+
+  case 4:
+    solved = SolveWith(m_Engine16, m_Learner16, grid, m_Stats, m_Partial, m_Stopped);
+    break;
+
+  case 5:
+    solved = SolveWith(m_Engine25, m_Learner25, grid, m_Stats, m_Partial, m_Stopped);
+    break;
+
+  case 6:
+    solved = SolveWith(m_Engine36, m_Learner36, grid, m_Stats, m_Partial, m_Stopped);
+    break;
+
+  default:
+    break;
+  }
+
+  // checked apart from the engines, a wrong solution counts as none
+  solved = solved && CGridValidator::isSolutionOf(grid, givens);
+
+  m_Stats.m_Micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  return solved;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
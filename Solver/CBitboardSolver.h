@@ -0,0 +1,1062 @@
+#ifndef CBitboardSolver_h__
+#define CBitboardSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CBitboardSolver.h
+  \brief    Candidate bitmask solver for Sudokus of box order 3 to 6.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include "CKernel16.h"
+#include "CLadder.h"
+#include "CAllDifferent.h"
+#include "CLearningEngine.h"
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CBitboardEngine
+  \brief    Solves grids of one box order with one candidate bitmask per cell.
+
+  Each cell keeps its remaining digits as a bitmask, each row, column
+  and box keeps the mask of the digits already placed in it. Naked singles
+  are found with a popcount, hidden singles by folding the masks of a unit
+  into "seen once" and "seen twice". The givens are then worked on with
+  the techniques of CLadder, which leaves most magazine grids without any
+  branching. Whatever remains is searched depth first, branching on the
+  cell with the fewest candidates.
+
+  The search works on a single state. Every mask it changes is logged
+  with its old value in a trail allocated once up front, and taking back
+  a branch replays the trail down to the mark of its level, so no node
+  copies a whole state or touches the heap.
+
+  All sizes are compile-time constants of CGridTraits, so each order gets
+  its own code without any size checks in the inner loops, with masks of
+  16 bits up to Hexadokus, 32 bits for 25x25 and 64 bits for 36x36 grids.
+  Units, peers and crossings come from the CGridTables of the layout of
+  the grid, so jigsaw and diagonal variants run the same code as the
+  plain grid.
+  Plain Hexadokus propagate with the whole-grid sweeps of CKernel16
+  instead.
+
+  On request every propagation ends with the matching of CAllDifferent,
+  which takes out each candidate no assignment of a whole unit can use.
+  It costs far more per node than singles and pays off on hard grids of
+  order 5 and 6 only.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CBitboardEngine
+{
+public:
+  typedef CGridTraits<Order>      Traits;
+  typedef typename Traits::Mask   Mask;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells,
+    Units = Traits::Units
+  };
+
+  //! where the techniques of CLadder are applied
+  enum Ladder
+  {
+    LadderOff,          //!< singles only
+    LadderAtRoot,       //!< on the givens, singles during the search
+    LadderEverywhere    //!< at every search node, fewest nodes but each one costs more
+  };
+
+  //! the complete search state of one level
+  struct CState
+  {
+    Mask          m_Candidates[Cells];  // remaining digits per cell
+    Mask          m_Units[Units];       // placed digits per row, column, region and diagonal
+    unsigned char m_Values[Cells];      // 0 = empty, else digit + 1
+    unsigned int  m_Placed;             // number of filled cells
+  };
+
+  CBitboardEngine();
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  bool Solve(CGrid & grid);
+
+  //! selects the layout of the grid, places its givens into the state and propagates them
+  bool Load(const CGrid & grid, CState & state);
+
+  //! searches states loaded by another engine, which must not load another layout meanwhile
+  void ShareLayout(const CBitboardEngine & other) { m_Layout.Share(other.m_Layout); }
+
+  //! places one more given (1-based) into a loaded state and propagates it with singles
+  bool Assign(CState & state, unsigned int cell, unsigned int value);
+
+  //! searches below the given state, Store() fetches the solution
+  bool Solve(const CState & state) { return 0 != Count(state, 1); }
+
+  //! counts the solutions below the given state up to the limit, Store() fetches the first
+  unsigned int Count(const CState & state, unsigned int limit);
+
+  //! appends the propagated child states of the cell with the fewest candidates
+  void Branch(const CState & state, std::vector<CState> & children);
+
+  //! writes the solution found by the last search into the grid
+  void Store(CGrid & grid) const;
+
+  //! stops the search once the flag is set or the node budget is used up (0 = no budget)
+  void SetLimits(const std::atomic<bool>* cancel, unsigned long budget);
+
+  //! counts the solutions into a total shared with other engines, the limit of Count() applies to it
+  void SetCounter(std::atomic<unsigned int>* counter) { m_Counter = counter; }
+
+  //! true if the last search was stopped by SetLimits() or SetDeadline() before it finished
+  bool isAborted() const { return m_Aborted; }
+
+  //! stops the search once the flag is set or the deadline has passed, both looked at every few nodes only
+  void SetDeadline(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last search was stopped by SetDeadline()
+  bool isStopped() const { return m_Stopped; }
+
+  //! writes the fullest state searched since Load() or ClearPartial() into the grid, returns its filled cells
+  unsigned int Partial(CGrid & grid) const;
+
+  //! forgets the fullest state, for engines searching states loaded by another one
+  void ClearPartial() { m_PartialPlaced = 0; }
+
+  //! the number of search nodes visited by the last search
+  unsigned long Nodes() const { return m_Nodes; }
+
+  //! true if every cell of the state is filled
+  static bool isSolved(const CState & state) { return Cells == state.m_Placed; }
+
+  //! the unfilled cell with the fewest candidates, Cells if there is none
+  static unsigned int SelectCell(const CState & state);
+
+  //! selects where the techniques of CLadder are applied
+  void UseLadder(Ladder ladder) { m_Ladder = ladder; }
+
+  //! enforces all-different on every unit by matching at each propagation
+  void UseMatching(bool matching) { m_Matching = matching; }
+
+  //! the techniques applied since the last call to Load()
+  const CTrace & Trace() const { return m_Trace; }
+
+  //! what the engine did since the last call to ResetStats()
+  const CSolveStats & Stats() const { return m_Stats; }
+
+  //! starts counting from zero again
+  void ResetStats() { m_Stats.Clear(); }
+
+private:
+  //! places a digit (0-based) and removes it from all peers
+  bool Place(CState & state, unsigned int cell, unsigned int digit);
+
+  //! applies singles and, if wanted, the ladder until nothing changes
+  bool Propagate(CState & state, bool ladder);
+
+  //! alternates singles and ladder steps until nothing changes, the trace gets the steps
+  bool PropagateLadder(CState & state, CTrace & step);
+
+  //! alternates singles and unit matching until nothing changes
+  bool PropagateMatching(CState & state);
+
+  //! adds the steps of one ladder propagation to the trace and the stats
+  void AddTrace(const CTrace & step);
+
+  //! applies naked and hidden singles until nothing changes
+  bool PropagateSingles(CState & state) { return PropagateSingles(state, std::integral_constant<bool, Order == 4>()); }
+
+  //! unit by unit propagation
+  bool PropagateSingles(CState & state, std::false_type);
+
+  //! whole-grid propagation using CKernel16
+  bool PropagateSingles(CState & state, std::true_type);
+
+  //! depth first search on the working state, the level is the depth
+  bool Search(unsigned int level);
+
+  //! true once the stop flag is set or the deadline has passed
+  bool isExpired();
+
+  //! logs the old value of a mask of the working state while searching
+  void Save(unsigned int index, Mask old);
+
+  //! logs the candidates changed since the snapshot in m_Before
+  void SaveChanges(const CState & state);
+
+  //! restores the working state to the given length of the trail
+  void Undo(size_t mark);
+
+  //! one logged change, the index tells which mask it belongs to
+  struct CUndo
+  {
+    unsigned short  m_Index;    // cell, Cells + unit, or Cells + Units + cell for a value
+    Mask            m_Old;
+  };
+
+  enum
+  {
+    // every entry removes a candidate, fills a cell or adds a digit to a unit
+    TrailSize = Cells * (Size + 2) + Units * Size,
+
+    // nodes between two looks at the stop flag and the clock, minus one
+    ClockMask = 255
+  };
+
+  CLayoutTables<Order>        m_Layout;     // units and peers of the loaded grid
+  CState                      m_State;      // the working state of the search
+  std::vector<CUndo>          m_Trail;      // changes of the working state, reserved up front
+  Mask                        m_Before[Cells]; // candidates before a sweep
+  bool                        m_Recording;  // true while the search changes m_State
+  std::vector<unsigned int>   m_Queue;      // cells that became naked singles
+  unsigned char               m_Solution[Cells];
+  unsigned int                m_Found;      // solutions seen by this engine
+  unsigned int                m_Limit;      // solutions wanted
+  std::atomic<unsigned int>*  m_Counter;    // total shared with other engines, may be NULL
+  unsigned long               m_Nodes;
+  unsigned long               m_Budget;     // node limit, 0 = none
+  const std::atomic<bool>*    m_Cancel;     // set by others to stop the search
+  const std::atomic<bool>*    m_Stop;       // set by the caller to give up the search
+  std::chrono::steady_clock::time_point m_Deadline;
+  bool                        m_Aborted;
+  bool                        m_Stopped;    // by the stop flag or the deadline
+  unsigned char               m_Partial[Cells]; // the fullest state searched
+  unsigned int                m_PartialPlaced;
+  Ladder                      m_Ladder;
+  bool                        m_Matching;   // all-different by matching at every propagation
+  CAllDifferent<Order>        m_AllDifferent; // the matchings of the last propagation
+  CTrace                      m_Trace;
+  CSolveStats                 m_Stats;      // counted by this engine only, merged by the caller
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CBitboardSolver
+  \brief    Dispatches a grid to the bitboard engine of its box order.
+
+  Grids the plain engine cannot solve within a small node budget are
+  handed to the learning engine, which does not get lost in the same
+  dead ends over and over again.
+
+  The engines enforce all-different by matching from 25x25 grids on.
+  SetMatching() changes that for the solvers created afterwards, so a
+  benchmark can compare the same corpus with and without it.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CBitboardSolver : public ISolver
+{
+public:
+  //! the orders the engines match on
+  enum Matching
+  {
+    MatchNone,      //!< no order, for comparing
+    MatchFrom25,    //!< 25x25 and 36x36 grids, the default
+    MatchAll        //!< every order
+  };
+
+  CBitboardSolver();
+  CBitboardSolver(const CBitboardSolver &); // not impl.
+  virtual ~CBitboardSolver();
+
+  //! the name of the solver backend
+  virtual const wchar_t* GetName() const;
+
+  //! classic Sudokus, Hexadokus, 25x25 and 36x36 grids are supported
+  virtual bool Supports(unsigned int order) const;
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  virtual bool Solve(CGrid & grid);
+
+  //! what the last call to Solve() did
+  virtual const CSolveStats & Stats() const;
+
+  //! stops Solve() once the flag is set or the deadline has passed
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last call to Solve() was stopped by the limits
+  virtual bool isStopped() const;
+
+  //! the fullest state the plain search of the last call to Solve() reached
+  virtual void Partial(CGrid & grid) const;
+
+  //! the number of search nodes visited by the last call to Solve()
+  unsigned long Nodes() const;
+
+  //! the matching of the solvers created from now on
+  static void SetMatching(Matching matching);
+
+private:
+  CBitboardEngine<3>  m_Engine9;
+  CBitboardEngine<4>  m_Engine16;
+  CBitboardEngine<5>  m_Engine25;
+  CBitboardEngine<6>  m_Engine36;
+  CLearningEngine<3>  m_Learner9;
+  CLearningEngine<4>  m_Learner16;
+  CLearningEngine<5>  m_Learner25;
+  CLearningEngine<6>  m_Learner36;
+  CSolveStats         m_Stats;
+  CGrid               m_Partial;
+  bool                m_Stopped;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CBitboardEngine implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CBitboardEngine<Order>::CBitboardEngine()
+  : m_Layout(),
+    m_Trail(),
+    m_Recording(false),
+    m_Queue(),
+    m_Found(0),
+    m_Limit(1),
+    m_Counter(NULL),
+    m_Nodes(0UL),
+    m_Budget(0UL),
+    m_Cancel(NULL),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Aborted(false),
+    m_Stopped(false),
+    m_PartialPlaced(0),
+    m_Ladder(LadderAtRoot),
+    m_Matching(false),
+    m_AllDifferent(),
+    m_Trace(),
+    m_Stats()
+{
+  m_Trail.reserve(TrailSize);
+  m_Queue.reserve(Cells);
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Solve( CGrid & grid )
+{
+  if(!Load(grid, m_State) || 0 == Count(m_State, 1))
+  {
+    return false;
+  }
+
+  Store(grid);
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Load( const CGrid & grid, CState & state )
+{
+  if(grid.Order() != Order || !m_Layout.Select(grid))
+  {
+    return false;
+  }
+
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    state.m_Candidates[i] = Traits::AllDigits;
+    state.m_Values[i] = 0;
+  }
+
+  for(unsigned int i=0; i<Units; ++i)
+  {
+    state.m_Units[i] = 0;
+  }
+
+  state.m_Placed = 0;
+  m_PartialPlaced = 0;
+  m_Queue.clear();
+  m_Trace.Clear();
+
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    const unsigned int value = grid.At(i);
+
+    if(value > Size || (0 != value && !Place(state, i, value - 1)))
+    {
+      m_Queue.clear();
+      return false;
+    }
+  }
+
+  return Propagate(state, LadderOff != m_Ladder);
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Assign( CState & state, unsigned int cell, unsigned int value )
+{
+  if(cell >= Cells || 0 == value || value > Size)
+  {
+    return false;
+  }
+
+  if(!Place(state, cell, value - 1) || !Propagate(state, false))
+  {
+    m_Queue.clear();
+    return false;
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+unsigned int CBitboardEngine<Order>::Count( const CState & state, unsigned int limit )
+{
+  m_Nodes = 0UL;
+  m_Found = 0;
+  m_Limit = limit;
+  m_Aborted = false;
+  m_Stopped = false;
+
+  // the root may be the working state itself
+  if(&state != &m_State)
+  {
+    m_State = state;
+  }
+
+  m_Trail.clear();
+  m_Recording = true;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  Search(0);
+
+  m_Stats.m_SearchMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  m_Stats.m_Nodes += m_Nodes;
+  m_Recording = false;
+
+  return m_Found;
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::Branch( const CState & state, std::vector<CState> & children )
+{
+  const unsigned int cell = SelectCell(state);
+
+  if(Cells == cell)
+  {
+    return;
+  }
+
+  Mask candidates = state.m_Candidates[cell];
+
+  while(0 != candidates)
+  {
+    const unsigned int digit = LowestBit(candidates);
+    candidates &= candidates - 1;
+
+    children.push_back(state);
+
+    if(!Place(children.back(), cell, digit) || !Propagate(children.back(), LadderEverywhere == m_Ladder))
+    {
+      children.pop_back();
+      m_Queue.clear();
+    }
+  }
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::Store( CGrid & grid ) const
+{
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    grid.SetAt(i, m_Solution[i]);
+  }
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::SetLimits( const std::atomic<bool>* cancel, unsigned long budget )
+{
+  m_Cancel = cancel;
+  m_Budget = budget;
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::SetDeadline( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+}
+
+template <unsigned int Order>
+unsigned int CBitboardEngine<Order>::Partial( CGrid & grid ) const
+{
+  if(0 != m_PartialPlaced)
+  {
+    for(unsigned int i=0; i<Cells; ++i)
+    {
+      grid.SetAt(i, m_Partial[i]);
+    }
+  }
+
+  return m_PartialPlaced;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::isExpired()
+{
+  m_Stopped = (NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+              (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline);
+
+  return m_Stopped;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Place( CState & state, unsigned int cell, unsigned int digit )
+{
+  const Mask bit = static_cast<Mask>(Mask(1) << digit);
+
+  if(0 != state.m_Values[cell])
+  {
+    return state.m_Values[cell] == digit + 1;
+  }
+
+  if(0 == (state.m_Candidates[cell] & bit))
+  {
+    return false;
+  }
+
+  const unsigned short* const units = m_Layout->m_CellUnits[cell];
+  const unsigned int count = m_Layout->m_UnitCount[cell];
+
+  Save(Cells + Units + cell, 0);
+  Save(cell, state.m_Candidates[cell]);
+
+  for(unsigned int k=0; k<count; ++k)
+  {
+    Save(Cells + units[k], state.m_Units[units[k]]);
+    state.m_Units[units[k]] |= bit;
+  }
+
+  state.m_Values[cell] = static_cast<unsigned char>(digit + 1);
+  state.m_Candidates[cell] = bit;
+  ++state.m_Placed;
+
+  const unsigned short* const peers = m_Layout->m_Peers[cell];
+  const unsigned int peerCount = m_Layout->m_PeerCount[cell];
+
+  for(unsigned int i=0; i<peerCount; ++i)
+  {
+    const unsigned int peer = peers[i];
+    Mask & candidates = state.m_Candidates[peer];
+
+    if(candidates & bit)
+    {
+      Save(peer, candidates);
+      candidates &= ~bit;
+
+      if(0 == state.m_Values[peer])
+      {
+        if(0 == candidates)
+        {
+          return false;
+        }
+
+        if(isSingle(candidates))
+        {
+          m_Queue.push_back(peer);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Propagate( CState & state, bool ladder )
+{
+  const unsigned int placed = state.m_Placed;
+
+  ++m_Stats.m_Propagations;
+
+  if(ladder && Cells != state.m_Placed)
+  {
+    // the clock is only read where the ladder runs, plain search nodes stay cheap
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CTrace step;
+
+    const bool valid = PropagateLadder(state, step);
+
+    // the singles get whatever the ladder steps did not take
+    step.m_Micros[Singles] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    for(unsigned int technique=PointingPair; technique<Techniques; ++technique)
+    {
+      step.m_Micros[Singles] -= step.m_Micros[technique];
+    }
+
+    AddTrace(step);
+
+    if(!valid)
+    {
+      return false;
+    }
+  }
+  else if(!PropagateSingles(state))
+  {
+    return false;
+  }
+
+  if(m_Matching && !PropagateMatching(state))
+  {
+    return false;
+  }
+
+  m_Trace.m_Count[Singles] += state.m_Placed - placed;
+  m_Stats.m_Steps[Singles] += state.m_Placed - placed;
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::PropagateLadder( CState & state, CTrace & step )
+{
+  if(!PropagateSingles(state))
+  {
+    return false;
+  }
+
+  while(Cells != state.m_Placed)
+  {
+    bool changed = false;
+
+    if(m_Recording)
+    {
+      memcpy(m_Before, state.m_Candidates, sizeof(m_Before));
+    }
+
+    const bool valid = CLadder<Order>::Step(*m_Layout, state.m_Candidates, state.m_Values, changed, step);
+
+    SaveChanges(state);
+
+    if(!valid)
+    {
+      return false;
+    }
+
+    if(!changed)
+    {
+      break;
+    }
+
+    // cells reduced to one candidate are naked singles now
+    for(unsigned int cell=0; cell<Cells; ++cell)
+    {
+      if(0 == state.m_Values[cell] && isSingle(state.m_Candidates[cell]))
+      {
+        m_Queue.push_back(cell);
+      }
+    }
+
+    if(!PropagateSingles(state))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::PropagateMatching( CState & state )
+{
+  while(Cells != state.m_Placed)
+  {
+    bool changed = false;
+
+    if(m_Recording)
+    {
+      memcpy(m_Before, state.m_Candidates, sizeof(m_Before));
+    }
+
+    const bool valid = m_AllDifferent.Propagate(*m_Layout, state.m_Candidates, state.m_Values, changed);
+
+    SaveChanges(state);
+
+    if(!valid)
+    {
+      return false;
+    }
+
+    if(!changed)
+    {
+      break;
+    }
+
+    for(unsigned int cell=0; cell<Cells; ++cell)
+    {
+      if(0 == state.m_Values[cell] && isSingle(state.m_Candidates[cell]))
+      {
+        m_Queue.push_back(cell);
+      }
+    }
+
+    if(!PropagateSingles(state))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::AddTrace( const CTrace & step )
+{
+  for(unsigned int technique=Singles; technique<Techniques; ++technique)
+  {
+    m_Trace.m_Count[technique] += step.m_Count[technique];
+    m_Trace.m_Micros[technique] += step.m_Micros[technique];
+    m_Stats.m_Steps[technique] += step.m_Count[technique];
+    m_Stats.m_TechniqueMicros[technique] += step.m_Micros[technique];
+  }
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::PropagateSingles( CState & state, std::false_type )
+{
+  bool changed = true;
+
+  while(changed)
+  {
+    // naked singles
+    while(!m_Queue.empty())
+    {
+      const unsigned int cell = m_Queue.back();
+      m_Queue.pop_back();
+
+      if(0 == state.m_Values[cell])
+      {
+        const Mask candidates = state.m_Candidates[cell];
+
+        if(0 == candidates || !Place(state, cell, LowestBit(candidates)))
+        {
+          m_Queue.clear();
+          return false;
+        }
+      }
+    }
+
+    if(Cells == state.m_Placed)
+    {
+      return true;
+    }
+
+    // hidden singles: digits seen exactly once within a unit
+    changed = false;
+
+    for(unsigned int unit=0; unit<m_Layout->m_UsedUnits; ++unit)
+    {
+      const Mask placed = state.m_Units[unit];
+
+      if(Traits::AllDigits == placed)
+      {
+        continue;
+      }
+
+      const unsigned short* const cells = m_Layout->m_Units[unit];
+      Mask once = 0;
+      Mask twice = 0;
+
+      for(unsigned int i=0; i<Size; ++i)
+      {
+        const unsigned int cell = cells[i];
+
+        if(0 == state.m_Values[cell])
+        {
+          const Mask candidates = state.m_Candidates[cell];
+          twice |= once & candidates;
+          once |= candidates;
+        }
+      }
+
+      if(Traits::AllDigits != (once | placed))
+      {
+        m_Queue.clear();
+        return false;   // a digit has no place left in this unit
+      }
+
+      Mask hidden = once & ~twice;
+
+      while(0 != hidden)
+      {
+        const unsigned int digit = LowestBit(hidden);
+        const Mask bit = static_cast<Mask>(Mask(1) << digit);
+        hidden &= hidden - 1;
+
+        for(unsigned int i=0; i<Size; ++i)
+        {
+          const unsigned int cell = cells[i];
+
+          if(0 == state.m_Values[cell] && (state.m_Candidates[cell] & bit))
+          {
+            if(!Place(state, cell, digit))
+            {
+              m_Queue.clear();
+              return false;
+            }
+
+            changed = true;
+            break;
+          }
+        }
+      }
+    }
+
+    changed = changed || !m_Queue.empty();
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::PropagateSingles( CState & state, std::true_type )
+{
+  // the sweeps know the boxes only
+  if(!m_Layout.isStandard())
+  {
+    return PropagateSingles(state, std::false_type());
+  }
+
+  // the sweeps see every single candidate, no need for the queue
+  m_Queue.clear();
+
+  // the sweeps rewrite the whole grid, the search logs what they changed
+  if(m_Recording)
+  {
+    memcpy(m_Before, state.m_Candidates, sizeof(m_Before));
+  }
+
+  bool changed = true;
+  bool valid = true;
+
+  while(changed && valid)
+  {
+    changed = false;
+
+    valid = CKernel16::Eliminate(state.m_Candidates, changed) &&
+            CKernel16::HiddenSingles(state.m_Candidates, changed);
+  }
+
+  SaveChanges(state);
+
+  if(!valid)
+  {
+    return false;
+  }
+
+  // take over the cells that became singles
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const Mask candidates = state.m_Candidates[cell];
+
+    if(0 == state.m_Values[cell] && isSingle(candidates))
+    {
+      const unsigned short* const units = m_Layout->m_CellUnits[cell];
+
+      Save(Cells + Units + cell, 0);
+      Save(Cells + units[0], state.m_Units[units[0]]);
+      Save(Cells + units[1], state.m_Units[units[1]]);
+      Save(Cells + units[2], state.m_Units[units[2]]);
+
+      state.m_Values[cell] = static_cast<unsigned char>(LowestBit(candidates) + 1);
+      state.m_Units[units[0]] |= candidates;
+      state.m_Units[units[1]] |= candidates;
+      state.m_Units[units[2]] |= candidates;
+      ++state.m_Placed;
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+inline void CBitboardEngine<Order>::Save( unsigned int index, Mask old )
+{
+  if(m_Recording)
+  {
+    const CUndo entry = { static_cast<unsigned short>(index), old };
+    m_Trail.push_back(entry);
+  }
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::SaveChanges( const CState & state )
+{
+  if(!m_Recording)
+  {
+    return;
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    if(m_Before[cell] != state.m_Candidates[cell])
+    {
+      Save(cell, m_Before[cell]);
+    }
+  }
+}
+
+template <unsigned int Order>
+void CBitboardEngine<Order>::Undo( size_t mark )
+{
+  while(m_Trail.size() > mark)
+  {
+    const CUndo & entry = m_Trail.back();
+    const unsigned int index = entry.m_Index;
+
+    if(index < Cells)
+    {
+      m_State.m_Candidates[index] = entry.m_Old;
+    }
+    else if(index < Cells + Units)
+    {
+      m_State.m_Units[index - Cells] = entry.m_Old;
+    }
+    else
+    {
+      m_State.m_Values[index - Cells - Units] = 0;
+    }
+
+    m_Trail.pop_back();
+  }
+}
+
+template <unsigned int Order>
+unsigned int CBitboardEngine<Order>::SelectCell( const CState & state )
+{
+  unsigned int best = Cells;
+  unsigned int bestCount = Size + 1;
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    if(0 == state.m_Values[cell])
+    {
+      const unsigned int count = PopCount(state.m_Candidates[cell]);
+
+      if(count < bestCount)
+      {
+        best = cell;
+        bestCount = count;
+
+        if(count <= 2)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+template <unsigned int Order>
+bool CBitboardEngine<Order>::Search( unsigned int level )
+{
+  CState & state = m_State;
+
+  ++m_Nodes;
+
+  if(level > m_Stats.m_MaxDepth)
+  {
+    m_Stats.m_MaxDepth = level;
+  }
+
+  // what is left to show if the search is given up
+  if(state.m_Placed > m_PartialPlaced)
+  {
+    memcpy(m_Partial, state.m_Values, sizeof(m_Partial));
+    m_PartialPlaced = state.m_Placed;
+  }
+
+  if(Cells == state.m_Placed)
+  {
+    if(0 == m_Found++)
+    {
+      memcpy(m_Solution, state.m_Values, sizeof(m_Solution));
+    }
+
+    // true ends the search, false goes on looking for more solutions
+    return (NULL != m_Counter ? ++*m_Counter : m_Found) >= m_Limit;
+  }
+
+  if((0 != m_Budget && m_Nodes > m_Budget) ||
+     (NULL != m_Cancel && m_Cancel->load(std::memory_order_relaxed)) ||
+     (0 == (m_Nodes & ClockMask) && isExpired()))
+  {
+    m_Aborted = true;
+    return false;
+  }
+
+  // branch on the cell with the fewest candidates
+  const unsigned int best = SelectCell(state);
+
+  Mask candidates = state.m_Candidates[best];
+  const size_t mark = m_Trail.size();
+  const unsigned int placed = state.m_Placed;
+
+  while(0 != candidates)
+  {
+    const unsigned int digit = LowestBit(candidates);
+    candidates &= candidates - 1;
+
+    if(Place(state, best, digit) && Propagate(state, LadderEverywhere == m_Ladder) && Search(level + 1))
+    {
+      return true;
+    }
+
+    m_Queue.clear();
+
+    Undo(mark);
+    state.m_Placed = placed;
+    ++m_Stats.m_Backtracks;
+
+    if(m_Aborted)
+    {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CBitboardSolver_h__
@@ -0,0 +1,207 @@
+#include "stdafx.h"
+#include "CCanonicalForm.h"
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CCanonicalForm.cpp
+  \brief    Canonical form of a Sudoku under its basic symmetries.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CCanonicalForm::CCanonicalForm( const CGrid & givens )
+  : m_Order(givens.Order()),
+    m_Transposed(false),
+    m_Found(false),
+    m_Grid(givens.Order())
+{
+  unsigned char bands[CGrid::MaxOrder];
+  unsigned char stacks[CGrid::MaxOrder];
+
+  for(unsigned int i=0; i<CGrid::MaxOrder; ++i)
+  {
+    m_Bands[i] = m_Stacks[i] = static_cast<unsigned char>(i);
+  }
+
+  memset(m_Labels, 0, sizeof(m_Labels));
+  memset(m_Digits, 0, sizeof(m_Digits));
+
+  for(unsigned int transposed=0; transposed<2; ++transposed)
+  {
+    for(unsigned int i=0; i<m_Order; ++i)
+    {
+      bands[i] = static_cast<unsigned char>(i);
+    }
+
+    do
+    {
+      for(unsigned int i=0; i<m_Order; ++i)
+      {
+        stacks[i] = static_cast<unsigned char>(i);
+      }
+
+      do
+      {
+        Evaluate(givens, 0 != transposed, bands, stacks);
+      }
+      while(std::next_permutation(stacks, stacks + m_Order));
+    }
+    while(std::next_permutation(bands, bands + m_Order));
+  }
+
+  // digits missing from the givens take the remaining labels in order
+  const unsigned int size = givens.Size();
+  unsigned int label = 1;
+
+  for(unsigned int digit=1; digit<=size; ++digit)
+  {
+    if(0 == m_Labels[digit])
+    {
+      while(0 != m_Digits[label])
+      {
+        ++label;
+      }
+
+      m_Labels[digit] = static_cast<unsigned char>(label);
+      m_Digits[label] = static_cast<unsigned char>(digit);
+    }
+  }
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    m_Grid.SetAt(i, m_Best[i]);
+  }
+}
+
+CGrid CCanonicalForm::ToCanonical( const CGrid & grid ) const
+{
+  CGrid result(m_Order);
+
+  for(unsigned int i=0; i<result.Cells(); ++i)
+  {
+    const unsigned int value = grid.At(Source(m_Order, m_Transposed, m_Bands, m_Stacks, i));
+
+    result.SetAt(i, 0 != value ? m_Labels[value] : 0);
+  }
+
+  return result;
+}
+
+CGrid CCanonicalForm::FromCanonical( const CGrid & grid ) const
+{
+  CGrid result(m_Order);
+
+  for(unsigned int i=0; i<result.Cells(); ++i)
+  {
+    const unsigned int value = grid.At(i);
+
+    result.SetAt(Source(m_Order, m_Transposed, m_Bands, m_Stacks, i), 0 != value ? m_Digits[value] : 0);
+  }
+
+  return result;
+}
+
+unsigned int CCanonicalForm::Source( unsigned int order, bool transposed, const unsigned char* bands, const unsigned char* stacks, unsigned int cell )
+{
+  const unsigned int size = order * order;
+  const unsigned int row = bands[cell / size / order] * order + cell / size % order;
+  const unsigned int col = stacks[cell % size / order] * order + cell % order;
+
+  return transposed ? col * size + row : row * size + col;
+}
+
+void CCanonicalForm::Evaluate( const CGrid & givens, bool transposed, const unsigned char* bands, const unsigned char* stacks )
+{
+  const unsigned int size = givens.Size();
+  unsigned int cols[CGrid::MaxSize];
+  unsigned char labels[CGrid::MaxSize + 1] = { 0 };
+  unsigned char cells[CGrid::MaxCells];
+  unsigned int next = 1;
+  bool smaller = !m_Found;
+
+  // most candidates lose within the first row, so the column offsets are
+  // filled in while it is scanned
+  for(unsigned int row=0, i=0; row<size; ++row)
+  {
+    const unsigned int src = bands[row / m_Order] * m_Order + row % m_Order;
+    const unsigned int offset = transposed ? src : src * size;
+
+    for(unsigned int col=0; col<size; ++col, ++i)
+    {
+      if(0 == row)
+      {
+        const unsigned int dst = stacks[col / m_Order] * m_Order + col % m_Order;
+
+        cols[col] = transposed ? dst * size : dst;
+      }
+
+      const unsigned int value = givens.At(offset + cols[col]);
+
+      if(0 != value && 0 == labels[value])
+      {
+        labels[value] = static_cast<unsigned char>(next++);
+      }
+
+      cells[i] = labels[value];
+
+      if(!smaller)
+      {
+        if(cells[i] > m_Best[i])
+        {
+          return;
+        }
+
+        smaller = cells[i] < m_Best[i];
+      }
+    }
+  }
+
+  // a candidate equal to the best changes nothing
+  if(!smaller)
+  {
+    return;
+  }
+
+  memcpy(m_Best, cells, givens.Cells());
+  memcpy(m_Bands, bands, m_Order);
+  memcpy(m_Stacks, stacks, m_Order);
+  memset(m_Digits, 0, sizeof(m_Digits));
+
+  for(unsigned int digit=0; digit<=givens.Size(); ++digit)
+  {
+    m_Labels[digit] = labels[digit];
+    m_Digits[labels[digit]] = static_cast<unsigned char>(digit);
+  }
+
+  m_Digits[0] = 0;
+  m_Transposed = transposed;
+  m_Found = true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,92 @@
+#ifndef CCanonicalForm_h__
+#define CCanonicalForm_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CCanonicalForm.h
+  \brief    Canonical form of a Sudoku under its basic symmetries.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CCanonicalForm
+  \brief    Maps a grid and all its relabelled, transposed and band or
+            stack permuted variants onto the same representative.
+
+  Every combination of transposition, band permutation and stack
+  permutation is tried. The digits of each candidate are relabelled in
+  the order they first appear, reading row by row. The representative
+  is the candidate with the smallest sequence of cells, where an empty
+  cell ranks below every digit. Candidates are dropped at the first cell
+  where they exceed the best so far, so most of them cost a few cells.
+
+  The transformation found for the givens maps any other grid of the
+  same coordinates, such as their solution, to and from canonical form.
+  Digits missing from the givens take the remaining labels in order.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CCanonicalForm
+{
+public:
+  //! computes the canonical form of the givens
+  explicit CCanonicalForm(const CGrid & givens);
+
+  //! the givens in canonical form
+  const CGrid & Grid() const { return m_Grid; }
+
+  //! moves and relabels a grid in the coordinates of the givens into canonical form
+  CGrid ToCanonical(const CGrid & grid) const;
+
+  //! moves and relabels a canonical grid back into the coordinates of the givens
+  CGrid FromCanonical(const CGrid & grid) const;
+
+private:
+  //! the cell of the givens a canonical cell is taken from
+  static unsigned int Source(unsigned int order, bool transposed, const unsigned char* bands, const unsigned char* stacks, unsigned int cell);
+
+  //! keeps one transformation of the givens if it is smaller than the best so far
+  void Evaluate(const CGrid & givens, bool transposed, const unsigned char* bands, const unsigned char* stacks);
+
+  unsigned int  m_Order;
+  bool          m_Transposed;
+  unsigned char m_Bands[CGrid::MaxOrder];       // band of the givens for each canonical band
+  unsigned char m_Stacks[CGrid::MaxOrder];      // stack of the givens for each canonical stack
+  unsigned char m_Labels[CGrid::MaxSize + 1];   // canonical label of each digit of the givens
+  unsigned char m_Digits[CGrid::MaxSize + 1];   // digit of the givens of each canonical label
+  unsigned char m_Best[CGrid::MaxCells];        // the smallest candidate so far
+  bool          m_Found;
+  CGrid         m_Grid;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CCanonicalForm_h__
@@ -0,0 +1,448 @@
+#include "stdafx.h"
+#include "CDlxSolver.h"
+#include "CGridValidator.h"
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CDlxSolver.cpp
+  \brief    Exact cover solver using Knuth's Dancing Links.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const uint32_t Root = 0;
+
+//! nodes between two looks at the stop flag and the clock, minus one
+const unsigned long ClockMask = 255UL;
+
+//! root + four constraint columns per cell and two per diagonal digit + up to six nodes per candidate
+const size_t MaxArena = 1 + 4 * CGrid::MaxCells + 2 * CGrid::MaxSize + 6 * CGrid::MaxCells * CGrid::MaxSize;
+
+//! the diagonals (bit 0 main, bit 1 anti) a cell lies on, if the grid has them
+unsigned int Diagonals( const CGrid & grid, unsigned int row, unsigned int col )
+{
+  if(!grid.hasDiagonals())
+  {
+    return 0;
+  }
+
+  return (row == col ? 1 : 0) | (row + col == grid.Size() - 1 ? 2 : 0);
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CDlxSolver::CDlxSolver()
+  : m_Arena(),
+    m_Solution(),
+    m_Deepest(),
+    m_Givens(),
+    m_Nodes(0UL),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Stopped(false),
+    m_Stats()
+{
+  m_Arena.reserve(MaxArena);
+  m_Solution.reserve(CGrid::MaxCells);
+  m_Deepest.reserve(CGrid::MaxCells);
+}
+
+CDlxSolver::~CDlxSolver()
+{
+}
+
+const wchar_t* CDlxSolver::GetName() const
+{
+  return L"Dancing Links";
+}
+
+bool CDlxSolver::Supports( unsigned int order ) const
+{
+  return order >= CGrid::MinOrder && order <= CGrid::MaxOrder;
+}
+
+const CSolveStats & CDlxSolver::Stats() const
+{
+  return m_Stats;
+}
+
+unsigned long CDlxSolver::Nodes() const
+{
+  return m_Nodes;
+}
+
+void CDlxSolver::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+}
+
+bool CDlxSolver::isStopped() const
+{
+  return m_Stopped;
+}
+
+void CDlxSolver::Partial( CGrid & grid ) const
+{
+  const unsigned int size = m_Givens.Size();
+
+  grid = m_Givens;
+
+  for(size_t i=0; i<m_Deepest.size(); ++i)
+  {
+    grid.SetAt(m_Deepest[i] / size, m_Deepest[i] % size + 1);
+  }
+}
+
+bool CDlxSolver::Solve( CGrid & grid )
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const Clock::time_point start = Clock::now();
+
+  m_Nodes = 0UL;
+  m_Solution.clear();
+  m_Deepest.clear();
+  m_Givens = grid;
+  m_Stopped = false;
+  m_Stats.Clear();
+  m_Stats.m_Backend = GetName();
+
+  const bool built = Supports(grid.Order()) && Build(grid);
+  const Clock::time_point searched = Clock::now();
+  const bool solved = built && Search();
+
+  m_Stats.m_Nodes = m_Nodes;
+  m_Stats.m_SearchMicros = std::chrono::duration<double, std::micro>(Clock::now() - searched).count();
+  m_Stats.m_Micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  if(!solved)
+  {
+    return false;
+  }
+
+  const unsigned int size = grid.Size();
+
+  for(size_t i=0; i<m_Solution.size(); ++i)
+  {
+    const uint32_t row = m_Solution[i];
+    grid.SetAt(row / size, row % size + 1);
+  }
+
+  // checked apart from the links, a wrong solution counts as none
+  return CGridValidator::isSolutionOf(grid, m_Givens);
+}
+
+bool CDlxSolver::Build( const CGrid & grid )
+{
+  const unsigned int size = grid.Size();
+  const unsigned int cells = grid.Cells();
+  const uint32_t columns = 4 * cells + (grid.hasDiagonals() ? 2 * size : 0);
+
+  // digits already placed per row, column, region and diagonal
+  uint64_t rows[CGrid::MaxSize] = {0};
+  uint64_t cols[CGrid::MaxSize] = {0};
+  uint64_t boxes[CGrid::MaxSize] = {0};
+  uint64_t diagonals[2] = {0};
+  unsigned int sizes[CGrid::MaxSize] = {0};
+
+  for(unsigned int cell=0; cell<cells; ++cell)
+  {
+    const unsigned int value = grid.At(cell);
+    const unsigned int r = cell / size;
+    const unsigned int c = cell % size;
+    const unsigned int b = grid.Region(cell);
+    const unsigned int d = Diagonals(grid, r, c);
+
+    // the exact cover needs regions of one digit each
+    if(b >= size || ++sizes[b] > size)
+    {
+      return false;
+    }
+
+    if(0 != value)
+    {
+      const uint64_t bit = uint64_t(1) << (value - 1);
+      uint64_t used = rows[r] | cols[c] | boxes[b];
+
+      used |= (d & 1) ? diagonals[0] : 0;
+      used |= (d & 2) ? diagonals[1] : 0;
+
+      if(value > size || (used & bit))
+      {
+        return false;
+      }
+
+      rows[r] |= bit;
+      cols[c] |= bit;
+      boxes[b] |= bit;
+      diagonals[0] |= (d & 1) ? bit : 0;
+      diagonals[1] |= (d & 2) ? bit : 0;
+    }
+  }
+
+  // root and column headers, the columns of satisfied constraints stay unlinked
+  m_Arena.resize(1 + columns);
+
+  CNode & root = m_Arena[Root];
+  root.m_Left = root.m_Right = Root;
+  root.m_Up = root.m_Down = root.m_Column = Root;
+  root.m_Row = 0;
+
+  for(uint32_t col=0; col<columns; ++col)
+  {
+    const uint32_t idx = col + 1;
+    const unsigned int index = col % cells;
+    const unsigned int digit = index % size;
+    const unsigned int unit = index / size;
+    bool open = false;
+
+    switch(col / cells)
+    {
+    case 0:   open = 0 == grid.At(index); break;
+    case 1:   open = 0 == (rows[unit] & (uint64_t(1) << digit)); break;
+    case 2:   open = 0 == (cols[unit] & (uint64_t(1) << digit)); break;
+    case 3:   open = 0 == (boxes[unit] & (uint64_t(1) << digit)); break;
+    default:  open = 0 == (diagonals[unit] & (uint64_t(1) << digit)); break;
+    }
+
+    CNode & header = m_Arena[idx];
+    header.m_Up = header.m_Down = header.m_Column = idx;
+    header.m_Row = 0;
+    header.m_Left = header.m_Right = idx;
+
+    if(open)
+    {
+      header.m_Left = m_Arena[Root].m_Left;
+      header.m_Right = Root;
+      m_Arena[m_Arena[Root].m_Left].m_Right = idx;
+      m_Arena[Root].m_Left = idx;
+    }
+  }
+
+  // one row per remaining candidate
+  for(unsigned int cell=0; cell<cells; ++cell)
+  {
+    if(0 != grid.At(cell))
+    {
+      continue;
+    }
+
+    const unsigned int r = cell / size;
+    const unsigned int c = cell % size;
+    const unsigned int b = grid.Region(cell);
+    const unsigned int d = Diagonals(grid, r, c);
+    uint64_t used = rows[r] | cols[c] | boxes[b];
+
+    used |= (d & 1) ? diagonals[0] : 0;
+    used |= (d & 2) ? diagonals[1] : 0;
+
+    for(unsigned int digit=0; digit<size; ++digit)
+    {
+      if(0 == (used & (uint64_t(1) << digit)))
+      {
+        uint32_t constraints[6] =
+        {
+          cell,
+          cells + r * size + digit,
+          2 * cells + c * size + digit,
+          3 * cells + b * size + digit
+        };
+
+        unsigned int count = 4;
+
+        if(d & 1)
+        {
+          constraints[count++] = 4 * cells + digit;
+        }
+
+        if(d & 2)
+        {
+          constraints[count++] = 4 * cells + size + digit;
+        }
+
+        AddRow(cell * size + digit, constraints, count);
+      }
+    }
+  }
+
+  return true;
+}
+
+void CDlxSolver::AddRow( uint32_t row, const uint32_t* columns, unsigned int count )
+{
+  const uint32_t first = static_cast<uint32_t>(m_Arena.size());
+
+  m_Arena.resize(first + count);
+
+  for(uint32_t i=0; i<count; ++i)
+  {
+    const uint32_t idx = first + i;
+    const uint32_t col = columns[i] + 1;
+    CNode & node = m_Arena[idx];
+    CNode & header = m_Arena[col];
+
+    node.m_Row = row;
+    node.m_Column = col;
+    node.m_Left = first + (i + count - 1) % count;
+    node.m_Right = first + (i + 1) % count;
+
+    // append at the bottom of the column
+    node.m_Up = header.m_Up;
+    node.m_Down = col;
+    m_Arena[header.m_Up].m_Down = idx;
+    header.m_Up = idx;
+    ++header.m_Row;
+  }
+}
+
+void CDlxSolver::Cover( uint32_t column )
+{
+  CNode* const nodes = &m_Arena[0];
+  CNode & header = nodes[column];
+
+  nodes[header.m_Right].m_Left = header.m_Left;
+  nodes[header.m_Left].m_Right = header.m_Right;
+
+  for(uint32_t i=header.m_Down; i!=column; i=nodes[i].m_Down)
+  {
+    for(uint32_t j=nodes[i].m_Right; j!=i; j=nodes[j].m_Right)
+    {
+      CNode & node = nodes[j];
+      nodes[node.m_Down].m_Up = node.m_Up;
+      nodes[node.m_Up].m_Down = node.m_Down;
+      --nodes[node.m_Column].m_Row;
+    }
+  }
+}
+
+void CDlxSolver::Uncover( uint32_t column )
+{
+  CNode* const nodes = &m_Arena[0];
+  CNode & header = nodes[column];
+
+  for(uint32_t i=header.m_Up; i!=column; i=nodes[i].m_Up)
+  {
+    for(uint32_t j=nodes[i].m_Left; j!=i; j=nodes[j].m_Left)
+    {
+      CNode & node = nodes[j];
+      ++nodes[node.m_Column].m_Row;
+      nodes[node.m_Down].m_Up = j;
+      nodes[node.m_Up].m_Down = j;
+    }
+  }
+
+  nodes[header.m_Right].m_Left = column;
+  nodes[header.m_Left].m_Right = column;
+}
+
+bool CDlxSolver::Search()
+{
+  const CNode* const nodes = &m_Arena[0];
+
+  ++m_Nodes;
+
+  if(nodes[Root].m_Right == Root)
+  {
+    return true;
+  }
+
+  if(0 == (m_Nodes & ClockMask))
+  {
+    m_Stopped = (NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+                (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline);
+
+    if(m_Stopped)
+    {
+      return false;
+    }
+  }
+
+  // the column with the fewest rows left
+  uint32_t column = nodes[Root].m_Right;
+
+  for(uint32_t c=nodes[column].m_Right; c!=Root && nodes[column].m_Row > 1; c=nodes[c].m_Right)
+  {
+    if(nodes[c].m_Row < nodes[column].m_Row)
+    {
+      column = c;
+    }
+  }
+
+  if(0 == nodes[column].m_Row)
+  {
+    return false;
+  }
+
+  Cover(column);
+
+  for(uint32_t r=nodes[column].m_Down; r!=column; r=nodes[r].m_Down)
+  {
+    m_Solution.push_back(nodes[r].m_Row);
+
+    if(m_Solution.size() > m_Stats.m_MaxDepth)
+    {
+      m_Stats.m_MaxDepth = static_cast<unsigned int>(m_Solution.size());
+      m_Deepest = m_Solution;
+    }
+
+    for(uint32_t j=nodes[r].m_Right; j!=r; j=nodes[j].m_Right)
+    {
+      Cover(nodes[j].m_Column);
+    }
+
+    if(Search())
+    {
+      return true;
+    }
+
+    // the matrix is built anew for the next grid, no need to restore it
+    if(m_Stopped)
+    {
+      return false;
+    }
+
+    for(uint32_t j=nodes[r].m_Left; j!=r; j=nodes[j].m_Left)
+    {
+      Uncover(nodes[j].m_Column);
+    }
+
+    m_Solution.pop_back();
+    ++m_Stats.m_Backtracks;
+  }
+
+  Uncover(column);
+
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
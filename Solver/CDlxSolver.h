@@ -0,0 +1,125 @@
+#ifndef CDlxSolver_h__
+#define CDlxSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CDlxSolver.h
+  \brief    Exact cover solver using Knuth's Dancing Links.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <stdint.h>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CDlxSolver
+  \brief    Models a Sudoku as exact cover problem and solves it with
+            Algorithm X on dancing links.
+
+  There is one column per cell, per digit in a row, per digit in a column,
+  per digit in a region and per digit on a diagonal if the grid has them,
+  and one row per candidate of an empty cell.
+  Columns satisfied by the givens and candidates ruled out by them are
+  left out of the matrix right away.
+
+  All header and row nodes live in one contiguous arena and are linked by
+  index. The arena is reset, but not released, between two puzzles.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CDlxSolver : public ISolver
+{
+public:
+  CDlxSolver();
+  CDlxSolver(const CDlxSolver &); // not impl.
+  virtual ~CDlxSolver();
+
+  //! the name of the solver backend
+  virtual const wchar_t* GetName() const;
+
+  //! all grid orders of CGrid are supported
+  virtual bool Supports(unsigned int order) const;
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  virtual bool Solve(CGrid & grid);
+
+  //! what the last call to Solve() did
+  virtual const CSolveStats & Stats() const;
+
+  //! stops Solve() once the flag is set or the deadline has passed
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last call to Solve() was stopped by the limits
+  virtual bool isStopped() const;
+
+  //! the givens of the last call to Solve() along with the deepest rows chosen
+  virtual void Partial(CGrid & grid) const;
+
+  //! the number of search nodes visited by the last call to Solve()
+  unsigned long Nodes() const;
+
+private:
+  //! a matrix node, header nodes use m_Row for their size
+  struct CNode
+  {
+    uint32_t m_Left;
+    uint32_t m_Right;
+    uint32_t m_Up;
+    uint32_t m_Down;
+    uint32_t m_Column;
+    uint32_t m_Row;     // cell * size + digit for row nodes
+  };
+
+  //! resets the arena and builds the matrix for the givens
+  bool Build(const CGrid & grid);
+
+  //! appends a candidate row of one node per constraint to the arena
+  void AddRow(uint32_t row, const uint32_t* columns, unsigned int count);
+
+  void Cover(uint32_t column);
+  void Uncover(uint32_t column);
+
+  //! Algorithm X, choosing the column with the fewest rows
+  bool Search();
+
+  std::vector<CNode>    m_Arena;      // root, column headers, then row nodes
+  std::vector<uint32_t> m_Solution;   // rows chosen so far
+  std::vector<uint32_t> m_Deepest;    // the most rows chosen at once
+  CGrid                 m_Givens;
+  unsigned long         m_Nodes;
+  const std::atomic<bool>* m_Stop;
+  std::chrono::steady_clock::time_point m_Deadline;
+  bool                  m_Stopped;
+  CSolveStats           m_Stats;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CDlxSolver_h__
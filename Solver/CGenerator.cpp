@@ -0,0 +1,398 @@
+#include "stdafx.h"
+#include "CGenerator.h"
+#include "CGrader.h"
+#include "CGridValidator.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGenerator.cpp
+  \brief    Seeded parallel generator of unique puzzles.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//! a random number below the limit, the same on every platform unlike std::uniform_int_distribution
+unsigned int Draw( std::mt19937 & rng, unsigned int limit )
+{
+  return static_cast<unsigned int>(rng() % limit);
+}
+
+//! Fisher-Yates shuffle with Draw(), std::shuffle differs between libraries
+template <typename T>
+void Shuffle( std::mt19937 & rng, T* first, unsigned int count )
+{
+  for(unsigned int i=count; i>1; --i)
+  {
+    std::swap(first[i - 1], first[Draw(rng, i)]);
+  }
+}
+
+//! writes the symbols of a grid as one line
+void WriteLine( const CGrid & grid, std::ostream & output )
+{
+  std::string line(grid.Cells(), '.');
+
+  for(unsigned int i=0; i<grid.Cells(); ++i)
+  {
+    line[i] = static_cast<char>(grid.Symbol(grid.At(i)));
+  }
+
+  output << line << '\n';
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+// CGeneratorReport
+//////////////////////////////////////////////////////////////////////////
+
+CGeneratorReport::CGeneratorReport()
+  : m_Puzzles(0UL),
+    m_Rejected(0UL),
+    m_Givens(0UL),
+    m_Threads(0),
+    m_Seconds(0.0)
+{
+  for(unsigned int i=0; i<=IGrader::Unsolvable; ++i)
+  {
+    m_Grades[i] = 0UL;
+  }
+}
+
+double CGeneratorReport::PuzzlesPerSecond() const
+{
+  return m_Seconds > 0.0 ? m_Puzzles / m_Seconds : 0.0;
+}
+
+std::wstring CGeneratorReport::ToString() const
+{
+  CGrader grader;
+  std::wostringstream str;
+
+  str << std::fixed << std::setprecision(1);
+  str << L"puzzles " << m_Puzzles << L" (rejected " << m_Rejected << L"), givens per puzzle "
+      << (0 != m_Puzzles ? double(m_Givens) / m_Puzzles : 0.0) << L"\n";
+  str << L"threads " << m_Threads << L", " << std::setprecision(3) << m_Seconds << L" s, "
+      << std::setprecision(1) << PuzzlesPerSecond() << L" puzzles/s\n";
+
+  for(unsigned int i=0; i<IGrader::Unsolvable; ++i)
+  {
+    str << (0 != i ? L", " : L"") << grader.GetName(static_cast<IGrader::Grade>(i)) << L" " << m_Grades[i];
+  }
+
+  str << L"\n";
+
+  return str.str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CGenerator
+//////////////////////////////////////////////////////////////////////////
+
+CGenerator::CGenerator( unsigned int threads )
+  : m_ThreadCount(0 != threads ? threads : std::thread::hardware_concurrency()),
+    m_Jobs(),
+    m_First(0UL),
+    m_Next(0),
+    m_Report()
+{
+  if(0 == m_ThreadCount)
+  {
+    m_ThreadCount = 1;
+  }
+}
+
+CGenerator::~CGenerator()
+{
+}
+
+bool CGenerator::Run( unsigned int order, unsigned long count, unsigned long seed, unsigned int givens, std::ostream & puzzles, std::ostream* solutions )
+{
+  m_Report = CGeneratorReport();
+  m_Report.m_Threads = m_ThreadCount;
+
+  if(order < CGrid::MinOrder || order > CGrid::MaxOrder)
+  {
+    return false;
+  }
+
+  const Clock::time_point start = Clock::now();
+
+  for(m_First=0UL; m_First<count; m_First+=ChunkSize)
+  {
+    m_Jobs.resize(std::min<unsigned long>(count - m_First, ChunkSize));
+    m_Next = 0;
+
+    // small enough that every thread gets a few blocks of the chunk
+    const unsigned int block = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(CLockstepSolver::Lanes(order), (m_Jobs.size() + 4 * m_ThreadCount - 1) / (4 * m_ThreadCount))));
+
+    std::vector<std::thread> threads;
+
+    for(unsigned int i=0; i<m_ThreadCount; ++i)
+    {
+      switch(order)
+      {
+      case 3:   threads.push_back(std::thread(&CGenerator::Work<3>, this, seed, givens, block)); break;
+      case 4:   threads.push_back(std::thread(&CGenerator::Work<4>, this, seed, givens, block)); break;
+      case 5:   threads.push_back(std::thread(&CGenerator::Work<5>, this, seed, givens, block)); break;
+      default:  threads.push_back(std::thread(&CGenerator::Work<6>, this, seed, givens, block)); break;
+      }
+    }
+
+    for(size_t i=0; i<threads.size(); ++i)
+    {
+      threads[i].join();
+    }
+
+    const CGrid* full[ChunkSize];
+    bool valid[ChunkSize];
+
+    for(size_t i=0; i<m_Jobs.size(); ++i)
+    {
+      full[i] = &m_Jobs[i].m_Solution;
+    }
+
+    // checked apart from the engines that filled them, the whole chunk in one go
+    CGridValidator::Validate(full, static_cast<unsigned int>(m_Jobs.size()), valid);
+
+    for(size_t i=0; i<m_Jobs.size(); ++i)
+    {
+      const CJob & job = m_Jobs[i];
+
+      if(!valid[i])
+      {
+        ++m_Report.m_Rejected;
+        continue;
+      }
+
+      WriteLine(job.m_Puzzle, puzzles);
+
+      if(NULL != solutions)
+      {
+        WriteLine(job.m_Solution, *solutions);
+      }
+
+      ++m_Report.m_Puzzles;
+      m_Report.m_Givens += job.m_Puzzle.CountGivens();
+      ++m_Report.m_Grades[job.m_Grade];
+    }
+  }
+
+  m_Report.m_Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  return puzzles.good() && (NULL == solutions || solutions->good());
+}
+
+template <unsigned int Order>
+void CGenerator::Work( unsigned long seed, unsigned int givens, unsigned int block )
+{
+  typedef CLockstepEngine<Order> Lockstep;
+
+  CBitboardEngine<Order> engine;
+  CGrader grader;
+  CLane lanes[Lockstep::Lanes];
+
+  // far too large for the stack of a thread
+  std::unique_ptr<Lockstep> lockstep(new Lockstep());
+
+  engine.UseLadder(CBitboardEngine<Order>::LadderOff);
+
+  for(size_t first = m_Next.fetch_add(block); first < m_Jobs.size(); first = m_Next.fetch_add(block))
+  {
+    const unsigned int count = static_cast<unsigned int>(std::min<size_t>(block, m_Jobs.size() - first));
+
+    for(unsigned int i=0; i<count; ++i)
+    {
+      const unsigned long number = m_First + static_cast<unsigned long>(first + i);
+
+      // the puzzle depends on the seed and its number only
+      std::seed_seq sequence = { static_cast<unsigned int>(seed), static_cast<unsigned int>(number) };
+      std::mt19937 rng(sequence);
+
+      lanes[i].m_Job = &m_Jobs[first + i];
+      Fill(engine, rng, lanes[i]);
+    }
+
+    Remove(engine, *lockstep, lanes, count, givens);
+
+    for(unsigned int i=0; i<count; ++i)
+    {
+      lanes[i].m_Job->m_Grade = grader.Rate(lanes[i].m_Job->m_Puzzle);
+    }
+  }
+}
+
+template <unsigned int Order>
+void CGenerator::Fill( CBitboardEngine<Order> & engine, std::mt19937 & rng, CLane & lane )
+{
+  typedef CBitboardEngine<Order> Engine;
+
+  CGrid & solution = lane.m_Job->m_Solution;
+
+  // the diagonal boxes do not see each other, any digits will do there
+  do
+  {
+    solution = CGrid(Order);
+
+    for(unsigned int box=0; box<Order; ++box)
+    {
+      unsigned char digits[Engine::Size];
+
+      for(unsigned int i=0; i<Engine::Size; ++i)
+      {
+        digits[i] = static_cast<unsigned char>(i + 1);
+      }
+
+      Shuffle(rng, digits, Engine::Size);
+
+      for(unsigned int i=0; i<Engine::Size; ++i)
+      {
+        solution.Set(box * Order + i / Order, box * Order + i % Order, digits[i]);
+      }
+    }
+
+    engine.SetLimits(NULL, FillBudget);
+  }
+  while(!engine.Solve(solution));
+
+  lane.m_Cells.resize(Engine::Cells);
+
+  for(unsigned int i=0; i<Engine::Cells; ++i)
+  {
+    lane.m_Cells[i] = static_cast<unsigned short>(i);
+  }
+
+  Shuffle(rng, &lane.m_Cells[0], Engine::Cells);
+
+  lane.m_Job->m_Puzzle = solution;
+  lane.m_Next = 0;
+  lane.m_Left = Engine::Cells;
+}
+
+template <unsigned int Order>
+void CGenerator::Remove( CBitboardEngine<Order> & engine, CLockstepEngine<Order> & lockstep, CLane* lanes, unsigned int count, unsigned int givens )
+{
+  typedef CBitboardEngine<Order> Engine;
+
+  engine.SetLimits(NULL, RemoveBudget);
+
+  for(;;)
+  {
+    unsigned int active = 0;
+
+    lockstep.Clear();
+
+    for(unsigned int i=0; i<count; ++i)
+    {
+      CLane & lane = lanes[i];
+
+      lane.m_Cell = Engine::Cells;
+
+      if(lane.m_Next >= Engine::Cells || lane.m_Left <= givens)
+      {
+        continue;
+      }
+
+      lane.m_Cell = lane.m_Cells[lane.m_Next++];
+      lane.m_Job->m_Puzzle.SetAt(lane.m_Cell, 0);
+
+      // any solution left has another digit in the cell
+      lockstep.Load(i, lane.m_Job->m_Puzzle);
+      lockstep.Exclude(i, lane.m_Cell, lane.m_Job->m_Solution.At(lane.m_Cell));
+      ++active;
+    }
+
+    if(0 == active)
+    {
+      break;
+    }
+
+    lockstep.Propagate();
+
+    for(unsigned int i=0; i<count; ++i)
+    {
+      CLane & lane = lanes[i];
+
+      if(Engine::Cells == lane.m_Cell)
+      {
+        continue;
+      }
+
+      CGrid & puzzle = lane.m_Job->m_Puzzle;
+      const unsigned int value = lane.m_Job->m_Solution.At(lane.m_Cell);
+      const IVerifier::Verdict verdict = lockstep.Result(i);
+
+      if(IVerifier::Contradictory == verdict || (IVerifier::Undecided == verdict && isForced(engine, puzzle, lane.m_Cell, value)))
+      {
+        --lane.m_Left;
+      }
+      else
+      {
+        puzzle.SetAt(lane.m_Cell, value);
+      }
+    }
+  }
+}
+
+template <unsigned int Order>
+bool CGenerator::isForced( CBitboardEngine<Order> & engine, const CGrid & puzzle, unsigned int cell, unsigned int value )
+{
+  typedef CBitboardEngine<Order> Engine;
+
+  typename Engine::CState state;
+
+  if(!engine.Load(puzzle, state))
+  {
+    return false;
+  }
+
+  // the removal is fine unless another digit fits the cell as well
+  if(0 == state.m_Values[cell])
+  {
+    state.m_Candidates[cell] &= ~static_cast<typename Engine::Mask>(typename Engine::Mask(1) << (value - 1));
+
+    return 0 == engine.Count(state, 1) && !engine.isAborted();
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,166 @@
+#ifndef CGenerator_h__
+#define CGenerator_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGenerator.h
+  \brief    Seeded parallel generator of unique puzzles.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "SolverAPI.h"
+#include "CBitboardSolver.h"
+#include "CLockstepSolver.h"
+#include <atomic>
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CGeneratorReport
+  \brief    Figures of one generator run.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CGeneratorReport
+{
+public:
+  CGeneratorReport();
+
+  //! the generated puzzles per second of wall-clock time
+  double PuzzlesPerSecond() const;
+
+  //! a few lines of text for the operator
+  std::wstring ToString() const;
+
+  unsigned long m_Puzzles;
+  unsigned long m_Rejected;                           // solutions CGridValidator rejected, not written
+  unsigned long m_Givens;                             // summed over all puzzles
+  unsigned long m_Grades[IGrader::Unsolvable + 1];    // puzzles per grade
+  unsigned int  m_Threads;
+  double        m_Seconds;                            // wall-clock time of the whole run
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CGenerator
+  \brief    Generates corpora of puzzles with a unique solution.
+
+  Each puzzle starts from a full grid, made of random diagonal boxes that
+  the bitboard engine completes, and loses its givens in random order as
+  long as the solution stays unique or until a given number of givens
+  is left, fewer givens make harder puzzles. Searches that exceed their node
+  budget count as ambiguous, which only keeps a few more givens.
+
+  A thread takes a block of puzzles, one per lane of a CLockstepEngine,
+  and tries a removal in each of them at once. The removed digit is ruled
+  out of its cell, so a lane that fails keeps the removal and a lane that
+  propagation solves shows a second solution. Only the lanes left open
+  are searched by the bitboard engine, which decides them as before.
+
+  Every puzzle draws from its own generator seeded with the run seed and
+  its index, so the output depends on the seed alone and neither on the
+  thread count nor on which thread took which puzzle. The puzzles are
+  written in the line format CBatchSolver reads, the solutions in the
+  same order into a second stream if one is given. The solutions of each
+  chunk go through CGridValidator first, a puzzle whose solution fails
+  is not written at all.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CGenerator
+{
+public:
+  //! uses one thread per hardware thread if no count is given
+  explicit CGenerator(unsigned int threads = 0);
+  CGenerator(const CGenerator &); // not impl.
+  ~CGenerator();
+
+  //! writes count puzzles of the given box order and optionally their solutions,
+  //! removing givens down to the given number (0 = as few as possible)
+  bool Run(unsigned int order, unsigned long count, unsigned long seed, unsigned int givens, std::ostream & puzzles, std::ostream* solutions);
+
+  //! the figures of the last call to Run()
+  const CGeneratorReport & Report() const { return m_Report; }
+
+private:
+  enum
+  {
+    ChunkSize     = 256,      // puzzles generated before they are written
+    FillBudget    = 100000,   // search nodes for completing the diagonal boxes
+    RemoveBudget  = 2000      // search nodes for the uniqueness check of a removal
+  };
+
+  //! one puzzle of the current chunk
+  struct CJob
+  {
+    CGrid           m_Puzzle;
+    CGrid           m_Solution;
+    IGrader::Grade  m_Grade;
+  };
+
+  //! a puzzle of a block losing its givens in one lane
+  struct CLane
+  {
+    CJob*                       m_Job;
+    std::vector<unsigned short> m_Cells;    // in the order of removal
+    unsigned int                m_Next;     // the next cell to try
+    unsigned int                m_Left;     // givens left
+    unsigned int                m_Cell;     // tried in this round, Cells if none
+  };
+
+  //! the loop of one thread working on the current chunk in blocks of at most Lanes puzzles
+  template <unsigned int Order>
+  void Work(unsigned long seed, unsigned int givens, unsigned int block);
+
+  //! fills a random full grid and shuffles the order in which the lane removes its givens
+  template <unsigned int Order>
+  static void Fill(CBitboardEngine<Order> & engine, std::mt19937 & rng, CLane & lane);
+
+  //! removes givens of the puzzles of all lanes while their solutions stay unique
+  template <unsigned int Order>
+  static void Remove(CBitboardEngine<Order> & engine, CLockstepEngine<Order> & lockstep, CLane* lanes, unsigned int count, unsigned int givens);
+
+  //! true if no other digit than the value fits the cell of the puzzle, searched by the bitboard engine
+  template <unsigned int Order>
+  static bool isForced(CBitboardEngine<Order> & engine, const CGrid & puzzle, unsigned int cell, unsigned int value);
+
+  unsigned int              m_ThreadCount;
+  std::vector<CJob>         m_Jobs;       // the current chunk
+  unsigned long             m_First;      // index of the first puzzle of the chunk
+  std::atomic<size_t>       m_Next;       // next job to take
+  CGeneratorReport          m_Report;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CGenerator_h__
@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "CGrader.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGrader.cpp
+  \brief    Rates Sudokus by the deduction techniques they need.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CGrader::CGrader()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36(),
+    m_Trace()
+{
+}
+
+CGrader::~CGrader()
+{
+}
+
+IGrader::Grade CGrader::Rate( const CGrid & grid )
+{
+  m_Trace.Clear();
+
+  switch(grid.Order())
+  {
+  case 3:   return Rate(m_Engine9, grid);
+  case 4:   return Rate(m_Engine16, grid);
+  case 5:   return Rate(m_Engine25, grid);
+  case 6:   return Rate(m_Engine36, grid);
+  default:  return Unsolvable;
+  }
+}
+
+const wchar_t* CGrader::GetName( Grade grade ) const
+{
+  switch(grade)
+  {
+  case Easy:      return L"Easy";
+  case Medium:    return L"Medium";
+  case Hard:      return L"Hard";
+  case Expert:    return L"Expert";
+  case Extreme:   return L"Extreme";
+  default:        return L"Unsolvable";
+  }
+}
+
+template <unsigned int Order>
+IGrader::Grade CGrader::Rate( CBitboardEngine<Order> & engine, const CGrid & grid )
+{
+  typename CBitboardEngine<Order>::CState state;
+
+  engine.UseLadder(CBitboardEngine<Order>::LadderAtRoot);
+
+  const bool consistent = engine.Load(grid, state);
+
+  m_Trace = engine.Trace();
+
+  if(!consistent)
+  {
+    return Unsolvable;
+  }
+
+  if(!CBitboardEngine<Order>::isSolved(state))
+  {
+    return Extreme;
+  }
+
+  switch(m_Trace.Hardest())
+  {
+  case Singles:
+    return Easy;
+
+  case PointingPair:
+  case BoxLineReduction:
+    return Medium;
+
+  case NakedPair:
+  case HiddenPair:
+    return Hard;
+
+  default:
+    return Expert;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,81 @@
+#ifndef CGrader_h__
+#define CGrader_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGrader.h
+  \brief    Rates Sudokus by the deduction techniques they need.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "CBitboardSolver.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CGrader
+  \brief    Grades a grid by the hardest step of the deduction ladder.
+
+  The givens are propagated with the ladder of CLadder, which always
+  falls back to the easiest technique that still makes progress. If the
+  grid gets filled that way, the hardest technique in the trace decides
+  the grade, otherwise a human would have to guess.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CGrader : public IGrader
+{
+public:
+  CGrader();
+  CGrader(const CGrader &); // not impl.
+  virtual ~CGrader();
+
+  //! rates the grid by the hardest technique needed to solve it
+  virtual Grade Rate(const CGrid & grid);
+
+  //! the printable name of a grade
+  virtual const wchar_t* GetName(Grade grade) const;
+
+  //! the techniques applied by the last call to Rate()
+  const CTrace & Trace() const { return m_Trace; }
+
+private:
+  //! propagates the grid with the engine of its order
+  template <unsigned int Order>
+  Grade Rate(CBitboardEngine<Order> & engine, const CGrid & grid);
+
+  CBitboardEngine<3>  m_Engine9;
+  CBitboardEngine<4>  m_Engine16;
+  CBitboardEngine<5>  m_Engine25;
+  CBitboardEngine<6>  m_Engine36;
+  CTrace              m_Trace;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CGrader_h__
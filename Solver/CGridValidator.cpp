@@ -0,0 +1,317 @@
+#include "stdafx.h"
+#include "CGridValidator.h"
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <immintrin.h>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGridValidator.cpp
+  \brief    Checks completed grids apart from the solvers that filled them.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const bool s_Avx2Available = DetectAvx2();
+
+bool s_UseAvx2 = s_Avx2Available;
+
+//! every cell filled and no digit twice in a row, column, region or diagonal
+template <unsigned int Order>
+bool isValidWith( const CGrid & grid )
+{
+  typedef CGridTraits<Order> Traits;
+  typedef typename Traits::Mask Mask;
+
+  Mask rows[Traits::Size] = {0};
+  Mask cols[Traits::Size] = {0};
+  Mask regions[Traits::Size] = {0};
+  Mask diagonals[2] = {0};
+
+  for(unsigned int cell=0; cell<Traits::Cells; ++cell)
+  {
+    const unsigned int value = grid.At(cell);
+    const unsigned int row = cell / Traits::Size;
+    const unsigned int col = cell % Traits::Size;
+    const unsigned int region = grid.Region(cell);
+
+    if(0 == value || value > Traits::Size || region >= Traits::Size)
+    {
+      return false;
+    }
+
+    const Mask bit = static_cast<Mask>(Mask(1) << (value - 1));
+
+    if(0 != ((rows[row] | cols[col] | regions[region]) & bit))
+    {
+      return false;
+    }
+
+    rows[row] |= bit;
+    cols[col] |= bit;
+    regions[region] |= bit;
+
+    if(!grid.hasDiagonals())
+    {
+      continue;
+    }
+
+    if(row == col)
+    {
+      if(0 != (diagonals[0] & bit))
+      {
+        return false;
+      }
+
+      diagonals[0] |= bit;
+    }
+
+    if(row + col == Traits::Size - 1)
+    {
+      if(0 != (diagonals[1] & bit))
+      {
+        return false;
+      }
+
+      diagonals[1] |= bit;
+    }
+  }
+
+  return true;
+}
+
+//! true if the grids from the first one on are plain grids of the order of the first, as many as the count
+bool isBlock( const CGrid* const* grids, unsigned int count )
+{
+  const unsigned int order = grids[0]->Order();
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    if(grids[i]->Order() != order || !grids[i]->isStandard())
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//! one bit per lane holding a valid grid, the lanes past the count repeat the last grid
+template <unsigned int Order>
+SUDOKU_TARGET_AVX2 uint32_t ValidLanes( const CGrid* const* grids, unsigned int count )
+{
+  typedef CGridTraits<Order> Traits;
+
+  // the rows, columns and boxes of a plain grid, laid out here rather than taken from the solver tables
+  unsigned short units[3 * Traits::Size][Traits::Size];
+
+  for(unsigned int unit=0; unit<Traits::Size; ++unit)
+  {
+    const unsigned int corner = (unit / Order) * Order * Traits::Size + (unit % Order) * Order;
+
+    for(unsigned int i=0; i<Traits::Size; ++i)
+    {
+      units[unit][i] = static_cast<unsigned short>(unit * Traits::Size + i);
+      units[Traits::Size + unit][i] = static_cast<unsigned short>(i * Traits::Size + unit);
+      units[2 * Traits::Size + unit][i] = static_cast<unsigned short>(corner + (i / Order) * Traits::Size + i % Order);
+    }
+  }
+
+  // cell by cell, the values of all lanes next to each other
+  unsigned char values[Traits::Cells][CGridValidator::Lanes];
+
+  for(unsigned int lane=0; lane<CGridValidator::Lanes; ++lane)
+  {
+    const CGrid & grid = *grids[lane < count ? lane : count - 1];
+
+    for(unsigned int cell=0; cell<Traits::Cells; ++cell)
+    {
+      values[cell][lane] = static_cast<unsigned char>(grid.At(cell));
+    }
+  }
+
+  // the low and high byte of the digit bit of each value minus one
+  const __m128i lowBits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i highBits = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i size = _mm_set1_epi8(static_cast<char>(Traits::Size));
+  const __m128i none = _mm_set1_epi8(-128);
+
+  __m256i bits[Traits::Cells];
+
+  for(unsigned int cell=0; cell<Traits::Cells; ++cell)
+  {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values[cell]));
+
+    // an empty cell wraps around to 0xFF, a value beyond Size gets the high bit, both shuffle to no bit at all
+    const __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(value, size), value);
+    const __m128i index = _mm_or_si128(_mm_sub_epi8(value, one), _mm_andnot_si128(inRange, none));
+
+    const __m128i low = _mm_shuffle_epi8(lowBits, index);
+    const __m128i high = _mm_shuffle_epi8(highBits, index);
+
+    bits[cell] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(low, high)), _mm_unpackhi_epi8(low, high), 1);
+  }
+
+  const __m256i all = _mm256_set1_epi16(static_cast<short>(Traits::AllDigits));
+  __m256i valid = _mm256_cmpeq_epi16(all, all);
+
+  for(unsigned int unit=0; unit<3 * Traits::Size; ++unit)
+  {
+    const unsigned short* const cells = units[unit];
+    __m256i digits = bits[cells[0]];
+
+    for(unsigned int i=1; i<Traits::Size; ++i)
+    {
+      digits = _mm256_or_si256(digits, bits[cells[i]]);
+    }
+
+    valid = _mm256_and_si256(valid, _mm256_cmpeq_epi16(digits, all));
+  }
+
+  const uint32_t bytes = static_cast<uint32_t>(_mm256_movemask_epi8(valid));
+  uint32_t lanes = 0;
+
+  for(unsigned int lane=0; lane<CGridValidator::Lanes; ++lane)
+  {
+    if(0 != (bytes & (1U << (2 * lane))))
+    {
+      lanes |= 1U << lane;
+    }
+  }
+
+  return lanes;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+bool CGridValidator::isValid( const CGrid & grid )
+{
+  switch(grid.Order())
+  {
+  case 3:   return isValidWith<3>(grid);
+  case 4:   return isValidWith<4>(grid);
+  case 5:   return isValidWith<5>(grid);
+  case 6:   return isValidWith<6>(grid);
+  default:  return false;
+  }
+}
+
+bool CGridValidator::isSolutionOf( const CGrid & solution, const CGrid & givens )
+{
+  if(!solution.hasSameLayout(givens))
+  {
+    return false;
+  }
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    if(0 != givens.At(i) && givens.At(i) != solution.At(i))
+    {
+      return false;
+    }
+  }
+
+  return isValid(solution);
+}
+
+unsigned int CGridValidator::Validate( const CGrid* const* grids, unsigned int count, bool* valid )
+{
+  return s_UseAvx2 ? ValidateAvx2(grids, count, valid) : ValidateScalar(grids, count, valid);
+}
+
+bool CGridValidator::isVectorized()
+{
+  return s_UseAvx2;
+}
+
+bool CGridValidator::Vectorize( bool enable )
+{
+  s_UseAvx2 = enable && s_Avx2Available;
+
+  return s_UseAvx2 == enable;
+}
+
+unsigned int CGridValidator::ValidateScalar( const CGrid* const* grids, unsigned int count, bool* valid )
+{
+  unsigned int passed = 0;
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    valid[i] = isValid(*grids[i]);
+
+    if(valid[i])
+    {
+      ++passed;
+    }
+  }
+
+  return passed;
+}
+
+SUDOKU_TARGET_AVX2 unsigned int CGridValidator::ValidateAvx2( const CGrid* const* grids, unsigned int count, bool* valid )
+{
+  unsigned int passed = 0;
+
+  for(unsigned int first=0; first<count; )
+  {
+    const unsigned int order = grids[first]->Order();
+    const unsigned int block = std::min<unsigned int>(count - first, Lanes);
+
+    // a lone grid is checked faster without the transposition
+    if(block < 2 || (3 != order && 4 != order) || !isBlock(grids + first, block))
+    {
+      passed += ValidateScalar(grids + first, 1, valid + first);
+      ++first;
+      continue;
+    }
+
+    const uint32_t lanes = 3 == order ? ValidLanes<3>(grids + first, block) : ValidLanes<4>(grids + first, block);
+
+    for(unsigned int lane=0; lane<block; ++lane)
+    {
+      valid[first + lane] = 0 != (lanes & (1U << lane));
+
+      if(valid[first + lane])
+      {
+        ++passed;
+      }
+    }
+
+    first += block;
+  }
+
+  return passed;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
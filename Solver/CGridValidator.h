@@ -0,0 +1,93 @@
+#ifndef CGridValidator_h__
+#define CGridValidator_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CGridValidator.h
+  \brief    Checks completed grids apart from the solvers that filled them.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CGridValidator
+  \brief    Checks that every row, column, region and diagonal of a full
+            grid holds each digit once.
+
+  Both versions lay out the units from the row, column and region of each
+  cell instead of taking the unit tables the solvers propagate with, so
+  the backends and the generator run their results through it before
+  handing them out. A solver bug then shows as an unsolved grid, not as
+  a wrong solution.
+
+  Single grids are checked cell by cell, with the layout of the grid.
+  Validate() takes plain 9x9 and 16x16 grids in blocks of 16, one grid
+  per 16 bit lane of an AVX2 register. Each cell is turned into its digit
+  bit with two byte shuffles, the cells of each unit are ORed together,
+  and one compare per unit tells the lanes holding all digits. A unit of
+  Size cells holding all Size digits holds each one once. Other orders,
+  variants and blocks of one grid take the scalar check.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CGridValidator
+{
+public:
+  enum
+  {
+    Lanes = 16    // grids checked at once by the AVX2 version
+  };
+
+  //! true if every cell holds a value and no unit of the layout holds one twice
+  static bool isValid(const CGrid & grid);
+
+  //! true if the solution is valid, has the layout of the givens and keeps every one of them
+  static bool isSolutionOf(const CGrid & solution, const CGrid & givens);
+
+  //! checks any number of grids as isValid() does, returns the number of valid ones
+  static unsigned int Validate(const CGrid* const* grids, unsigned int count, bool* valid);
+
+  //! true if the AVX2 version is in use
+  static bool isVectorized();
+
+  //! switches between the AVX2 and scalar versions, false if AVX2 is not available
+  static bool Vectorize(bool enable);
+
+  // both versions, exposed for comparing their results
+  static unsigned int ValidateScalar(const CGrid* const* grids, unsigned int count, bool* valid);
+  static unsigned int ValidateAvx2(const CGrid* const* grids, unsigned int count, bool* valid);
+
+private:
+  CGridValidator(); // not impl.
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CGridValidator_h__
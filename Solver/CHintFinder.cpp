@@ -0,0 +1,335 @@
+#include "stdafx.h"
+#include "CHintFinder.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CHintFinder.cpp
+  \brief    Finds the simplest next step for a human solver.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+// CHintEngine
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CHintEngine<Order>::CHintEngine()
+  : m_Layout(),
+    m_Grid(Order),
+    m_Valid(false)
+{
+}
+
+template <unsigned int Order>
+CHint CHintEngine<Order>::Next( const CGrid & grid )
+{
+  CHint hint;
+
+  if(!Sync(grid, hint))
+  {
+    m_Valid = false;
+    return hint;
+  }
+
+  while(!FindSingle(hint))
+  {
+    if(CHint::Solved == hint.m_Kind || CHint::Contradiction == hint.m_Kind || !Eliminate(hint))
+    {
+      break;
+    }
+  }
+
+  return hint;
+}
+
+template <unsigned int Order>
+bool CHintEngine<Order>::Sync( const CGrid & grid, CHint & hint )
+{
+  bool fresh = !m_Valid || !grid.hasSameLayout(m_Grid);
+
+  for(unsigned int cell=0; cell<Cells && !fresh; ++cell)
+  {
+    fresh = 0 != m_Grid.At(cell) && grid.At(cell) != m_Grid.At(cell);
+  }
+
+  if(fresh)
+  {
+    if(!m_Layout.Select(grid))
+    {
+      hint.m_Kind = CHint::Contradiction;
+      return false;
+    }
+
+    for(unsigned int cell=0; cell<Cells; ++cell)
+    {
+      m_Candidates[cell] = Traits::AllDigits;
+      m_Values[cell] = 0;
+    }
+
+    m_Grid = CGrid(Order);
+    m_Grid.SetLayout(grid);
+    m_Valid = true;
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const unsigned int digit = grid.At(cell);
+
+    if(0 == digit || 0 != m_Values[cell])
+    {
+      continue;
+    }
+
+    if(digit > Size || !Place(cell, digit))
+    {
+      hint.m_Kind = CHint::Contradiction;
+      hint.m_Cell = cell;
+      hint.m_Digit = digit;
+      return false;
+    }
+
+    m_Grid.SetAt(cell, digit);
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CHintEngine<Order>::Place( unsigned int cell, unsigned int digit )
+{
+  const Mask bit = static_cast<Mask>(Mask(1) << (digit - 1));
+  const typename CLayoutTables<Order>::Tables & tables = *m_Layout;
+
+  if(0 == (m_Candidates[cell] & bit))
+  {
+    return false;
+  }
+
+  m_Values[cell] = static_cast<unsigned char>(digit);
+  m_Candidates[cell] = bit;
+
+  for(unsigned int i=0; i<tables.m_PeerCount[cell]; ++i)
+  {
+    m_Candidates[tables.m_Peers[cell][i]] &= ~bit;
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CHintEngine<Order>::FindSingle( CHint & hint ) const
+{
+  const typename CLayoutTables<Order>::Tables & tables = *m_Layout;
+  bool open = false;
+
+  // a cell with a single candidate is the easiest to spot
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    if(0 != m_Values[cell])
+    {
+      continue;
+    }
+
+    const Mask bits = m_Candidates[cell];
+
+    open = true;
+
+    if(bits <= 1 || 0 == (bits & (bits - 1)))
+    {
+      hint.m_Kind = 0 == bits ? CHint::Contradiction : CHint::NakedSingle;
+      hint.m_Cell = cell;
+      hint.m_Digit = 0 == bits ? 0 : LowestBit(bits) + 1;
+      return 0 != bits;
+    }
+  }
+
+  if(!open)
+  {
+    hint.m_Kind = CHint::Solved;
+    return false;
+  }
+
+  // the digits with exactly one open place in a unit, the ones with none contradict
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    Mask placed = 0;
+    Mask once = 0;
+    Mask twice = 0;
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const unsigned int cell = cells[i];
+
+      if(0 != m_Values[cell])
+      {
+        placed |= m_Candidates[cell];
+        continue;
+      }
+
+      twice |= once & m_Candidates[cell];
+      once |= m_Candidates[cell];
+    }
+
+    const Mask missing = static_cast<Mask>(Traits::AllDigits & ~(placed | once));
+    const Mask single = static_cast<Mask>(once & ~twice & ~placed);
+
+    if(0 != missing)
+    {
+      hint.m_Kind = CHint::Contradiction;
+      hint.m_Unit = unit;
+      hint.m_Digit = LowestBit(missing) + 1;
+      return false;
+    }
+
+    if(0 == single)
+    {
+      continue;
+    }
+
+    const unsigned int digit = LowestBit(single);
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      if(0 == m_Values[cells[i]] && 0 != (m_Candidates[cells[i]] & (Mask(1) << digit)))
+      {
+        hint.m_Kind = CHint::HiddenSingle;
+        hint.m_Cell = cells[i];
+        hint.m_Digit = digit + 1;
+        hint.m_Unit = unit;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+template <unsigned int Order>
+bool CHintEngine<Order>::Eliminate( CHint & hint )
+{
+  typedef CLadder<Order> Ladder;
+
+  const typename CLayoutTables<Order>::Tables & tables = *m_Layout;
+  bool changed = false;
+
+  for(unsigned int technique=PointingPair; technique<Techniques; ++technique)
+  {
+    bool ok = true;
+
+    switch(technique)
+    {
+    case PointingPair:      ok = Ladder::PointingPairs(tables, m_Candidates, m_Values, changed); break;
+    case BoxLineReduction:  ok = Ladder::BoxLineReductions(tables, m_Candidates, m_Values, changed); break;
+    case NakedPair:         ok = Ladder::NakedSubsets(tables, m_Candidates, m_Values, 2, changed); break;
+    case HiddenPair:        ok = Ladder::HiddenSubsets(tables, m_Candidates, m_Values, 2, changed); break;
+    case NakedTriple:       ok = Ladder::NakedSubsets(tables, m_Candidates, m_Values, 3, changed); break;
+    case HiddenTriple:      ok = Ladder::HiddenSubsets(tables, m_Candidates, m_Values, 3, changed); break;
+    default:                ok = Ladder::XWings(tables, m_Candidates, m_Values, changed); break;
+    }
+
+    if(!ok)
+    {
+      hint.m_Kind = CHint::Contradiction;
+      return false;
+    }
+
+    if(changed)
+    {
+      if(technique > static_cast<unsigned int>(hint.m_Technique))
+      {
+        hint.m_Technique = static_cast<Technique>(technique);
+      }
+
+      return true;
+    }
+  }
+
+  hint.m_Kind = CHint::Stuck;
+
+  return false;
+}
+
+template class CHintEngine<3>;
+template class CHintEngine<4>;
+template class CHintEngine<5>;
+template class CHintEngine<6>;
+
+//////////////////////////////////////////////////////////////////////////
+// CHintFinder
+//////////////////////////////////////////////////////////////////////////
+
+CHintFinder::CHintFinder()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36()
+{
+}
+
+CHint CHintFinder::Next( const CGrid & grid )
+{
+  switch(grid.Order())
+  {
+  case 3:   return m_Engine9.Next(grid);
+  case 4:   return m_Engine16.Next(grid);
+  case 5:   return m_Engine25.Next(grid);
+  case 6:   return m_Engine36.Next(grid);
+  default:  break;
+  }
+
+  CHint hint;
+
+  hint.m_Kind = CHint::Contradiction;
+
+  return hint;
+}
+
+void CHintFinder::Reset()
+{
+  m_Engine9.Reset();
+  m_Engine16.Reset();
+  m_Engine25.Reset();
+  m_Engine36.Reset();
+}
+
+const wchar_t* CHintFinder::GetName( Technique technique )
+{
+  switch(technique)
+  {
+  case Singles:           return L"Singles";
+  case PointingPair:      return L"Pointing pair";
+  case BoxLineReduction:  return L"Box-line reduction";
+  case NakedPair:         return L"Naked pair";
+  case HiddenPair:        return L"Hidden pair";
+  case NakedTriple:       return L"Naked triple";
+  case HiddenTriple:      return L"Hidden triple";
+  default:                return L"X-Wing";
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
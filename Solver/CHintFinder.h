@@ -0,0 +1,163 @@
+#ifndef CHintFinder_h__
+#define CHintFinder_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CHintFinder.h
+  \brief    Finds the simplest next step for a human solver.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "SolverTraits.h"
+#include "CLadder.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \struct   CHint
+  \brief    A digit a human solver can place next and how to find it.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+struct CHint
+{
+  //! what was found
+  enum Kind
+  {
+    NakedSingle,        //!< the digit is the last candidate of the cell
+    HiddenSingle,       //!< the cell is the last place of the digit in m_Unit
+    Solved,             //!< no cell is left open
+    Stuck,              //!< the techniques of the ladder do not place any digit
+    Contradiction       //!< m_Cell, or m_Digit in m_Unit, has no candidate left
+  };
+
+  Kind          m_Kind;
+  unsigned int  m_Cell;
+  unsigned int  m_Digit;
+  unsigned int  m_Unit;         // rows, columns, regions, diagonals as in CGridTables
+  Technique     m_Technique;    // the hardest one that removed candidates before the single showed
+
+  CHint() : m_Kind(Stuck), m_Cell(0), m_Digit(0), m_Unit(0), m_Technique(Singles) {}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CHintEngine
+  \brief    Keeps the candidates of a grid between two hints.
+
+  Digits added to the grid since the last hint only remove their digit
+  from their peers, everything else is kept: the candidates removed by
+  the ladder stay removed, so a hint seldom needs more than a scan for
+  singles. A grid that lost or changed a digit, or has another layout,
+  starts over from its givens.
+
+  The techniques are tried easiest first and each is applied only until
+  a single shows up, so a hint never needs a harder technique than the
+  grid requires at that point.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CHintEngine
+{
+public:
+  typedef CGridTraits<Order> Traits;
+  typedef typename Traits::Mask Mask;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells
+  };
+
+  CHintEngine();
+  CHintEngine(const CHintEngine &); // not impl.
+
+  //! the next step for the grid
+  CHint Next(const CGrid & grid);
+
+  //! forgets the candidates of the last grid
+  void Reset() { m_Valid = false; }
+
+private:
+  //! brings the candidates up to the digits of the grid, false if a new digit is no candidate
+  bool Sync(const CGrid & grid, CHint & hint);
+
+  //! places a digit and removes it from the peers of its cell, false if it is no candidate
+  bool Place(unsigned int cell, unsigned int digit);
+
+  //! the first naked or hidden single, false if there is none
+  bool FindSingle(CHint & hint) const;
+
+  //! removes candidates by the easiest technique that finds any, false if none does
+  bool Eliminate(CHint & hint);
+
+  CLayoutTables<Order>  m_Layout;
+  CGrid                 m_Grid;                   // as of the last hint
+  Mask                  m_Candidates[Cells];
+  unsigned char         m_Values[Cells];
+  bool                  m_Valid;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CHintFinder
+  \brief    Tells a human solver which digit to place next.
+
+  Meant to be asked again after each digit the user places: each order
+  keeps its CHintEngine, so a hint takes microseconds instead of a solve.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CHintFinder
+{
+public:
+  CHintFinder();
+  CHintFinder(const CHintFinder &); // not impl.
+
+  //! the simplest next step for the grid
+  CHint Next(const CGrid & grid);
+
+  //! forgets the candidates kept for all orders
+  void Reset();
+
+  //! the printable name of a technique
+  static const wchar_t* GetName(Technique technique);
+
+private:
+  CHintEngine<3>  m_Engine9;
+  CHintEngine<4>  m_Engine16;
+  CHintEngine<5>  m_Engine25;
+  CHintEngine<6>  m_Engine36;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CHintFinder_h__
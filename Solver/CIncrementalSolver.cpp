@@ -0,0 +1,149 @@
+#include "stdafx.h"
+#include "CIncrementalSolver.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CIncrementalSolver.cpp
+  \brief    Solver taking the givens one at a time.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! loads an empty grid into the state
+template <unsigned int Order>
+bool Reset( CBitboardEngine<Order> & engine, typename CBitboardEngine<Order>::CState & state, CGrid & forced )
+{
+  forced = CGrid(Order);
+
+  return engine.Load(forced, state);
+}
+
+//! places the given and copies the cells it forces
+template <unsigned int Order>
+bool Assign( CBitboardEngine<Order> & engine, typename CBitboardEngine<Order>::CState & state, unsigned int cell, unsigned int value, CGrid & forced )
+{
+  if(!engine.Assign(state, cell, value))
+  {
+    return false;
+  }
+
+  for(unsigned int i=0; i<CBitboardEngine<Order>::Cells; ++i)
+  {
+    forced.SetAt(i, state.m_Values[i]);
+  }
+
+  return true;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CIncrementalSolver::CIncrementalSolver()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36(),
+    m_Forced(),
+    m_Contradictory(false)
+{
+  // singles are all there is time for between two chunks of a scan
+  m_Engine9.UseLadder(CBitboardEngine<3>::LadderOff);
+  m_Engine16.UseLadder(CBitboardEngine<4>::LadderOff);
+  m_Engine25.UseLadder(CBitboardEngine<5>::LadderOff);
+  m_Engine36.UseLadder(CBitboardEngine<6>::LadderOff);
+
+  Reset(m_Forced.Order());
+}
+
+CIncrementalSolver::~CIncrementalSolver()
+{
+}
+
+bool CIncrementalSolver::Reset( unsigned int order )
+{
+  m_Contradictory = false;
+
+  switch(order)
+  {
+  case 3:   return Sudoku::Reset(m_Engine9, m_State9, m_Forced);
+  case 4:   return Sudoku::Reset(m_Engine16, m_State16, m_Forced);
+  case 5:   return Sudoku::Reset(m_Engine25, m_State25, m_Forced);
+  case 6:   return Sudoku::Reset(m_Engine36, m_State36, m_Forced);
+  }
+
+  return false;
+}
+
+bool CIncrementalSolver::Assign( unsigned int cell, unsigned int value )
+{
+  if(m_Contradictory)
+  {
+    return false;
+  }
+
+  bool assigned = false;
+
+  switch(m_Forced.Order())
+  {
+  case 3:
+    assigned = Sudoku::Assign(m_Engine9, m_State9, cell, value, m_Forced);
+    break;
+
+  case 4:
+    assigned = Sudoku::Assign(m_Engine16, m_State16, cell, value, m_Forced);
+    break;
+
+  case 5:
+    assigned = Sudoku::Assign(m_Engine25, m_State25, cell, value, m_Forced);
+    break;
+
+  case 6:
+    assigned = Sudoku::Assign(m_Engine36, m_State36, cell, value, m_Forced);
+    break;
+  }
+
+  // a half propagated state is of no use any more
+  m_Contradictory = !assigned;
+
+  return assigned;
+}
+
+bool CIncrementalSolver::isContradictory() const
+{
+  return m_Contradictory;
+}
+
+const CGrid & CIncrementalSolver::Forced() const
+{
+  return m_Forced;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,87 @@
+#ifndef CIncrementalSolver_h__
+#define CIncrementalSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CIncrementalSolver.h
+  \brief    Solver taking the givens one at a time.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "SolverAPI.h"
+#include "CBitboardSolver.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CIncrementalSolver
+  \brief    Propagates the givens of a Sudoku as they come in.
+
+  Each given is placed into the candidate state of a CBitboardEngine and
+  its naked and hidden singles are followed at once, so a grid read band
+  by band is mostly filled by the time its last given arrives. Singles
+  only depend on the rules, never on the givens still missing, so every
+  forced cell belongs to the final solution as well.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CIncrementalSolver : public IIncrementalSolver
+{
+public:
+  CIncrementalSolver();
+  CIncrementalSolver(const CIncrementalSolver &); // not impl.
+  virtual ~CIncrementalSolver();
+
+  //! starts over with an empty grid of the given box order
+  virtual bool Reset(unsigned int order);
+
+  //! adds a given, returns false if it contradicts the givens so far
+  virtual bool Assign(unsigned int cell, unsigned int value);
+
+  //! true if the givens so far have no solution
+  virtual bool isContradictory() const;
+
+  //! the givens so far along with every cell they force
+  virtual const CGrid & Forced() const;
+
+private:
+  CBitboardEngine<3>            m_Engine9;
+  CBitboardEngine<4>            m_Engine16;
+  CBitboardEngine<5>            m_Engine25;
+  CBitboardEngine<6>            m_Engine36;
+  CBitboardEngine<3>::CState    m_State9;
+  CBitboardEngine<4>::CState    m_State16;
+  CBitboardEngine<5>::CState    m_State25;
+  CBitboardEngine<6>::CState    m_State36;
+  CGrid                         m_Forced;
+  bool                          m_Contradictory;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CIncrementalSolver_h__
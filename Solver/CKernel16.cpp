@@ -0,0 +1,396 @@
+#include "stdafx.h"
+#include "CKernel16.h"
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include <immintrin.h>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CKernel16.cpp
+  \brief    Whole-grid candidate propagation for Hexadokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+typedef CGridTraits<4> Traits;
+
+const uint16_t AllDigits = 0xFFFF;
+
+const bool s_Avx2Available = DetectAvx2();
+
+bool s_UseAvx2 = s_Avx2Available;
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2 helpers, one register holds the 16 cells of a row
+
+//! merges the once/twice masks of a partner into the own ones
+SUDOKU_TARGET_AVX2 inline void Combine(__m256i & once, __m256i & twice, const __m256i & otherOnce, const __m256i & otherTwice)
+{
+  twice = _mm256_or_si256(_mm256_or_si256(twice, otherTwice), _mm256_and_si256(once, otherOnce));
+  once = _mm256_or_si256(once, otherOnce);
+}
+
+//! swaps neighbouring 16 bit lanes
+SUDOKU_TARGET_AVX2 inline __m256i Swap16(const __m256i & x)
+{
+  return _mm256_or_si256(_mm256_srli_epi32(x, 16), _mm256_slli_epi32(x, 16));
+}
+
+//! reduces groups of four lanes, i.e. the four columns of a box
+SUDOKU_TARGET_AVX2 inline void Reduce4(__m256i & once, __m256i & twice)
+{
+  Combine(once, twice, Swap16(once), Swap16(twice));
+  Combine(once, twice, _mm256_shuffle_epi32(once, 0xB1), _mm256_shuffle_epi32(twice, 0xB1));
+}
+
+//! reduces all sixteen lanes, i.e. a complete row
+SUDOKU_TARGET_AVX2 inline void Reduce16(__m256i & once, __m256i & twice)
+{
+  Reduce4(once, twice);
+  Combine(once, twice, _mm256_shuffle_epi32(once, 0x4E), _mm256_shuffle_epi32(twice, 0x4E));
+  Combine(once, twice, _mm256_permute2x128_si256(once, once, 0x01), _mm256_permute2x128_si256(twice, twice, 0x01));
+}
+
+//! all-ones in every lane holding exactly one bit
+SUDOKU_TARGET_AVX2 inline __m256i SingleLanes(const __m256i & v)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i pow2 = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_sub_epi16(v, _mm256_set1_epi16(1))), zero);
+
+  return _mm256_andnot_si256(_mm256_cmpeq_epi16(v, zero), pow2);
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+bool CKernel16::isVectorized()
+{
+  return s_UseAvx2;
+}
+
+bool CKernel16::Vectorize( bool enable )
+{
+  s_UseAvx2 = enable && s_Avx2Available;
+
+  return s_UseAvx2 == enable;
+}
+
+bool CKernel16::Eliminate( uint16_t* candidates, bool & changed )
+{
+  return s_UseAvx2 ? EliminateAvx2(candidates, changed) : EliminateScalar(candidates, changed);
+}
+
+bool CKernel16::HiddenSingles( uint16_t* candidates, bool & changed )
+{
+  return s_UseAvx2 ? HiddenSinglesAvx2(candidates, changed) : HiddenSinglesScalar(candidates, changed);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool CKernel16::EliminateScalar( uint16_t* candidates, bool & changed )
+{
+  const Traits::Tables & tables = Traits::Standard();
+  uint16_t placed[Traits::Units];
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    uint16_t once = 0;
+    uint16_t twice = 0;
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const uint16_t v = candidates[cells[i]];
+
+      if(isSingle(v))
+      {
+        twice |= once & v;
+        once |= v;
+      }
+    }
+
+    if(0 != twice)
+    {
+      return false;   // the same digit placed twice
+    }
+
+    placed[unit] = once;
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const uint16_t v = candidates[cell];
+
+    if(!isSingle(v))
+    {
+      const unsigned short* const units = tables.m_CellUnits[cell];
+      const uint16_t n = v & ~(placed[units[0]] | placed[units[1]] | placed[units[2]]);
+
+      if(0 == n)
+      {
+        return false;
+      }
+
+      if(n != v)
+      {
+        candidates[cell] = n;
+        changed = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool CKernel16::HiddenSinglesScalar( uint16_t* candidates, bool & changed )
+{
+  const Traits::Tables & tables = Traits::Standard();
+  uint16_t unique[Traits::Units];
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    uint16_t once = 0;
+    uint16_t twice = 0;
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const uint16_t v = candidates[cells[i]];
+      twice |= once & v;
+      once |= v;
+    }
+
+    if(AllDigits != once)
+    {
+      return false;   // a digit has no place left
+    }
+
+    unique[unit] = once & ~twice;
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const uint16_t v = candidates[cell];
+    const unsigned short* const units = tables.m_CellUnits[cell];
+    const uint16_t h = v & (unique[units[0]] | unique[units[1]] | unique[units[2]]);
+
+    if(0 != h)
+    {
+      if(!isSingle(h))
+      {
+        return false;   // two digits that must both go here
+      }
+
+      if(h != v)
+      {
+        candidates[cell] = h;
+        changed = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SUDOKU_TARGET_AVX2 bool CKernel16::EliminateAvx2( uint16_t* candidates, bool & changed )
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i* const rows = reinterpret_cast<__m256i*>(candidates);
+
+  __m256i v[Size];
+  __m256i singles[Size];
+  __m256i digits[Size];
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    v[r] = _mm256_loadu_si256(rows + r);
+    singles[r] = SingleLanes(v[r]);
+    digits[r] = _mm256_and_si256(v[r], singles[r]);
+  }
+
+  __m256i conflicts = zero;
+
+  // columns: reduce across the registers
+  __m256i colOnce = zero;
+  __m256i colTwice = zero;
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    colTwice = _mm256_or_si256(colTwice, _mm256_and_si256(colOnce, digits[r]));
+    colOnce = _mm256_or_si256(colOnce, digits[r]);
+  }
+
+  conflicts = _mm256_or_si256(conflicts, colTwice);
+
+  // boxes: reduce four registers, then four lanes
+  __m256i boxOnce[4];
+
+  for(unsigned int band=0; band<4; ++band)
+  {
+    __m256i once = zero;
+    __m256i twice = zero;
+
+    for(unsigned int r=4*band; r<4*band + 4; ++r)
+    {
+      twice = _mm256_or_si256(twice, _mm256_and_si256(once, digits[r]));
+      once = _mm256_or_si256(once, digits[r]);
+    }
+
+    Reduce4(once, twice);
+
+    boxOnce[band] = once;
+    conflicts = _mm256_or_si256(conflicts, twice);
+  }
+
+  // rows: reduce across the lanes, then strip the placed digits
+  __m256i empty = zero;
+  __m256i diff = zero;
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    __m256i once = digits[r];
+    __m256i twice = zero;
+
+    Reduce16(once, twice);
+
+    conflicts = _mm256_or_si256(conflicts, twice);
+
+    const __m256i placed = _mm256_or_si256(once, _mm256_or_si256(colOnce, boxOnce[r / 4]));
+    const __m256i n = _mm256_or_si256(digits[r], _mm256_andnot_si256(singles[r], _mm256_andnot_si256(placed, v[r])));
+
+    empty = _mm256_or_si256(empty, _mm256_cmpeq_epi16(n, zero));
+    diff = _mm256_or_si256(diff, _mm256_xor_si256(n, v[r]));
+
+    _mm256_storeu_si256(rows + r, n);
+  }
+
+  if(!_mm256_testz_si256(conflicts, conflicts) || !_mm256_testz_si256(empty, empty))
+  {
+    return false;
+  }
+
+  if(!_mm256_testz_si256(diff, diff))
+  {
+    changed = true;
+  }
+
+  return true;
+}
+
+SUDOKU_TARGET_AVX2 bool CKernel16::HiddenSinglesAvx2( uint16_t* candidates, bool & changed )
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi16(-1);
+  __m256i* const rows = reinterpret_cast<__m256i*>(candidates);
+
+  __m256i v[Size];
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    v[r] = _mm256_loadu_si256(rows + r);
+  }
+
+  __m256i missing = zero;
+
+  // columns
+  __m256i colOnce = zero;
+  __m256i colTwice = zero;
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    colTwice = _mm256_or_si256(colTwice, _mm256_and_si256(colOnce, v[r]));
+    colOnce = _mm256_or_si256(colOnce, v[r]);
+  }
+
+  missing = _mm256_or_si256(missing, _mm256_xor_si256(colOnce, ones));
+
+  const __m256i colUnique = _mm256_andnot_si256(colTwice, colOnce);
+
+  // boxes
+  __m256i boxUnique[4];
+
+  for(unsigned int band=0; band<4; ++band)
+  {
+    __m256i once = zero;
+    __m256i twice = zero;
+
+    for(unsigned int r=4*band; r<4*band + 4; ++r)
+    {
+      twice = _mm256_or_si256(twice, _mm256_and_si256(once, v[r]));
+      once = _mm256_or_si256(once, v[r]);
+    }
+
+    Reduce4(once, twice);
+
+    missing = _mm256_or_si256(missing, _mm256_xor_si256(once, ones));
+    boxUnique[band] = _mm256_andnot_si256(twice, once);
+  }
+
+  // rows, then reduce every cell to the unique digits it holds
+  __m256i atMostOne = ones;
+  __m256i diff = zero;
+
+  for(unsigned int r=0; r<Size; ++r)
+  {
+    __m256i once = v[r];
+    __m256i twice = zero;
+
+    Reduce16(once, twice);
+
+    missing = _mm256_or_si256(missing, _mm256_xor_si256(once, ones));
+
+    const __m256i unique = _mm256_or_si256(_mm256_andnot_si256(twice, once), _mm256_or_si256(colUnique, boxUnique[r / 4]));
+    const __m256i h = _mm256_and_si256(v[r], unique);
+    const __m256i none = _mm256_cmpeq_epi16(h, zero);
+    const __m256i n = _mm256_or_si256(_mm256_and_si256(none, v[r]), _mm256_andnot_si256(none, h));
+
+    atMostOne = _mm256_and_si256(atMostOne, _mm256_cmpeq_epi16(_mm256_and_si256(h, _mm256_sub_epi16(h, _mm256_set1_epi16(1))), zero));
+    diff = _mm256_or_si256(diff, _mm256_xor_si256(n, v[r]));
+
+    _mm256_storeu_si256(rows + r, n);
+  }
+
+  // a cell with two or more unique digits clears its lane of atMostOne
+  if(!_mm256_testz_si256(missing, missing) || !_mm256_testc_si256(atMostOne, ones))
+  {
+    return false;
+  }
+
+  if(!_mm256_testz_si256(diff, diff))
+  {
+    changed = true;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,88 @@
+#ifndef CKernel16_h__
+#define CKernel16_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CKernel16.h
+  \brief    Whole-grid candidate propagation for Hexadokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CKernel16
+  \brief    Propagation sweeps over the 256 candidate masks of a Hexadoku.
+
+  The 512 bytes of candidates are exactly sixteen 256 bit registers, one
+  per row. Row unions are reduced across the lanes of a register, column
+  unions across the registers and box unions across four registers and
+  four lanes. Units are reduced into "seen once" and "seen twice" masks,
+  which yields the placed digits, the hidden singles and all conflicts
+  with a handful of OR and AND-NOT operations.
+
+  AVX2 is used if the processor supports it, otherwise a scalar version
+  computing the same results.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CKernel16
+{
+public:
+  enum
+  {
+    Size  = 16,
+    Cells = Size * Size
+  };
+
+  //! removes the digit of every single-candidate cell from its peers
+  static bool Eliminate(uint16_t* candidates, bool & changed);
+
+  //! reduces every cell holding a digit unique to one of its units to that digit
+  static bool HiddenSingles(uint16_t* candidates, bool & changed);
+
+  //! true if the AVX2 version is in use
+  static bool isVectorized();
+
+  //! switches between the AVX2 and scalar versions, false if AVX2 is not available
+  static bool Vectorize(bool enable);
+
+  // both versions, exposed for comparing their results
+  static bool EliminateScalar(uint16_t* candidates, bool & changed);
+  static bool HiddenSinglesScalar(uint16_t* candidates, bool & changed);
+  static bool EliminateAvx2(uint16_t* candidates, bool & changed);
+  static bool HiddenSinglesAvx2(uint16_t* candidates, bool & changed);
+
+private:
+  CKernel16(); // not impl.
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CKernel16_h__
@@ -0,0 +1,596 @@
+#ifndef CLadder_h__
+#define CLadder_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLadder.h
+  \brief    Human-style deduction techniques on candidate bitmasks.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+//! the deduction techniques, easiest first
+enum Technique
+{
+  Singles,
+  PointingPair,
+  BoxLineReduction,
+  NakedPair,
+  HiddenPair,
+  NakedTriple,
+  HiddenTriple,
+  XWing,
+  Techniques
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \struct   CTrace
+  \brief    Counts how often each technique made progress and the time it took.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+struct CTrace
+{
+  unsigned long m_Count[Techniques];
+  double        m_Micros[Techniques];
+
+  CTrace() { Clear(); }
+
+  //! forgets all counts
+  void Clear()
+  {
+    for(unsigned int i=0; i<Techniques; ++i)
+    {
+      m_Count[i] = 0UL;
+      m_Micros[i] = 0.0;
+    }
+  }
+
+  //! the hardest technique that was needed
+  Technique Hardest() const
+  {
+    unsigned int hardest = Singles;
+
+    for(unsigned int i=Singles; i<Techniques; ++i)
+    {
+      if(0UL != m_Count[i])
+      {
+        hardest = i;
+      }
+    }
+
+    return static_cast<Technique>(hardest);
+  }
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLadder
+  \brief    Removes candidates by the techniques a human solver would use.
+
+  Every technique works on whole units at once, all of them on the
+  transposed masks holding the positions of each digit in each unit:
+  pointing pairs and box-line reductions test these against the cells a
+  unit shares with a crossing one, hidden subsets OR them for two or three
+  digits, naked subsets do the same on the masks of two or three cells,
+  and X-Wings compare them across rows or columns.
+
+  Units and their crossings come from CGridTables only, so irregular
+  regions and diagonals are handled like any other unit.
+
+  Filled cells are skipped, so the values array decides which cells are
+  still open. A technique returns false if it emptied a cell, which means
+  the candidates contradict each other.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CLadder
+{
+public:
+  typedef CGridTraits<Order>        Traits;
+  typedef typename Traits::Mask     Mask;
+  typedef typename Traits::Tables   Tables;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells,
+    Units = Traits::Units
+  };
+
+  //! applies the easiest technique that removes any candidate and counts it and the time of each tried one in the trace
+  static bool Step(const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed, CTrace & trace);
+
+  //! a digit confined to the cells a region shares with a line leaves the rest of the line
+  static bool PointingPairs(const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed);
+
+  //! a digit confined to the cells a line shares with a region leaves the rest of the region
+  static bool BoxLineReductions(const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed);
+
+  //! k cells of a unit sharing k digits remove them from the other cells
+  static bool NakedSubsets(const Tables & tables, Mask* candidates, const unsigned char* values, unsigned int k, bool & changed);
+
+  //! k digits of a unit sharing k cells remove all other digits from them
+  static bool HiddenSubsets(const Tables & tables, Mask* candidates, const unsigned char* values, unsigned int k, bool & changed);
+
+  //! a digit on the same two columns of two rows leaves those columns elsewhere, and vice versa
+  static bool XWings(const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed);
+
+private:
+  CLadder(); // not impl.
+
+  //! the open positions of each digit per unit, shared by the techniques working on them
+  struct CPlaces
+  {
+    Mask m_Places[Units][Size];
+    Mask m_Placed[Units];
+  };
+
+  //! pointing pairs (regions) or box-line reductions (lines and diagonals) on positions computed before
+  static bool LockedCandidates(const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & places, bool regions, bool & changed);
+
+  //! hidden subsets on positions computed before
+  static bool HiddenSubsets(const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & places, unsigned int k, bool & changed);
+
+  //! X-Wings on positions computed before
+  static bool XWings(const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & places, bool & changed);
+
+  //! removes the bits from an open cell, false if nothing is left
+  static bool Remove(Mask* candidates, const unsigned char* values, unsigned int cell, Mask bits, bool & changed);
+
+  //! collects the sets of k masks, each with 2 to k bits, whose union holds exactly k bits
+  static unsigned int Subsets(const Mask* masks, unsigned int count, unsigned int k, Mask* members, Mask* unions);
+
+  //! the open positions of each digit within each unit and the digits placed in each unit
+  static void Places(const Tables & tables, const Mask* candidates, const unsigned char* values, CPlaces & places);
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CLadder implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+bool CLadder<Order>::Step( const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed, CTrace & trace )
+{
+  // the candidates stay the same until a technique changes them, so the positions are computed once
+  CPlaces places;
+
+  Places(tables, candidates, values, places);
+  changed = false;
+
+  for(unsigned int technique=PointingPair; technique<Techniques && !changed; ++technique)
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool ok = true;
+
+    switch(technique)
+    {
+    case PointingPair:      ok = LockedCandidates(tables, candidates, values, places, true, changed); break;
+    case BoxLineReduction:  ok = LockedCandidates(tables, candidates, values, places, false, changed); break;
+    case NakedPair:         ok = NakedSubsets(tables, candidates, values, 2, changed); break;
+    case HiddenPair:        ok = HiddenSubsets(tables, candidates, values, places, 2, changed); break;
+    case NakedTriple:       ok = NakedSubsets(tables, candidates, values, 3, changed); break;
+    case HiddenTriple:      ok = HiddenSubsets(tables, candidates, values, places, 3, changed); break;
+    default:                ok = XWings(tables, candidates, values, places, changed); break;
+    }
+
+    trace.m_Micros[technique] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    if(!ok)
+    {
+      return false;
+    }
+
+    if(changed)
+    {
+      ++trace.m_Count[technique];
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::Remove( Mask* candidates, const unsigned char* values, unsigned int cell, Mask bits, bool & changed )
+{
+  if(0 != values[cell] || 0 == (candidates[cell] & bits))
+  {
+    return true;
+  }
+
+  candidates[cell] &= ~bits;
+  changed = true;
+
+  return 0 != candidates[cell];
+}
+
+template <unsigned int Order>
+void CLadder<Order>::Places( const Tables & tables, const Mask* candidates, const unsigned char* values, CPlaces & result )
+{
+  Mask (&places)[Units][Size] = result.m_Places;
+  Mask (&placed)[Units] = result.m_Placed;
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    placed[unit] = 0;
+
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      places[unit][digit] = 0;
+    }
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const unsigned short* const units = tables.m_CellUnits[cell];
+    const unsigned char* const positions = tables.m_Positions[cell];
+    const unsigned int count = tables.m_UnitCount[cell];
+
+    if(0 != values[cell])
+    {
+      const Mask bit = static_cast<Mask>(Mask(1) << (values[cell] - 1));
+
+      for(unsigned int k=0; k<count; ++k)
+      {
+        placed[units[k]] |= bit;
+      }
+
+      continue;
+    }
+
+    for(Mask bits=candidates[cell]; 0 != bits; bits &= bits - 1)
+    {
+      const unsigned int digit = LowestBit(bits);
+
+      for(unsigned int k=0; k<count; ++k)
+      {
+        places[units[k]][digit] |= static_cast<Mask>(Mask(1) << positions[k]);
+      }
+    }
+  }
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::PointingPairs( const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed )
+{
+  CPlaces places;
+
+  Places(tables, candidates, values, places);
+
+  return LockedCandidates(tables, candidates, values, places, true, changed);
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::BoxLineReductions( const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed )
+{
+  CPlaces places;
+
+  Places(tables, candidates, values, places);
+
+  return LockedCandidates(tables, candidates, values, places, false, changed);
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::LockedCandidates( const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & positions, bool regions, bool & changed )
+{
+  const Mask (&places)[Units][Size] = positions.m_Places;
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    if(regions != (unit >= 2 * Size && unit < 3 * Size))
+    {
+      continue;
+    }
+
+    for(unsigned int k=0; k<tables.m_CrossingCount[unit]; ++k)
+    {
+      const typename Tables::CCrossing & crossing = tables.m_Crossings[unit][k];
+      Mask only = 0;
+
+      // the digits with all their open places among the shared cells
+      for(unsigned int digit=0; digit<Size; ++digit)
+      {
+        const Mask where = places[unit][digit];
+
+        if(0 != where && 0 == (where & ~crossing.m_Inside))
+        {
+          only |= static_cast<Mask>(Mask(1) << digit);
+        }
+      }
+
+      if(0 == only)
+      {
+        continue;
+      }
+
+      const unsigned short* const cells = tables.m_Units[crossing.m_Unit];
+
+      for(unsigned int pos=0; pos<Size; ++pos)
+      {
+        if(0 == (crossing.m_Other & (Mask(1) << pos)) && !Remove(candidates, values, cells[pos], only, changed))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+unsigned int CLadder<Order>::Subsets( const Mask* masks, unsigned int count, unsigned int k, Mask* members, Mask* unions )
+{
+  unsigned int found = 0;
+
+  for(unsigned int a=0; a<count; ++a)
+  {
+    for(unsigned int b=a + 1; b<count; ++b)
+    {
+      const Mask ab = masks[a] | masks[b];
+
+      if(2 == k)
+      {
+        if(2 == PopCount(ab) && found < Size)
+        {
+          members[found] = static_cast<Mask>((Mask(1) << a) | (Mask(1) << b));
+          unions[found++] = ab;
+        }
+
+        continue;
+      }
+
+      if(PopCount(ab) > 3)
+      {
+        continue;
+      }
+
+      for(unsigned int c=b + 1; c<count; ++c)
+      {
+        const Mask abc = ab | masks[c];
+
+        if(3 == PopCount(abc) && found < Size)
+        {
+          members[found] = static_cast<Mask>((Mask(1) << a) | (Mask(1) << b) | (Mask(1) << c));
+          unions[found++] = abc;
+        }
+      }
+    }
+  }
+
+  return found;
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::NakedSubsets( const Tables & tables, Mask* candidates, const unsigned char* values, unsigned int k, bool & changed )
+{
+  Mask masks[Size];
+  unsigned int positions[Size];
+  Mask members[Size];
+  Mask unions[Size];
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    unsigned int count = 0;
+
+    for(unsigned int pos=0; pos<Size; ++pos)
+    {
+      const unsigned int cell = cells[pos];
+      const unsigned int bits = PopCount(candidates[cell]);
+
+      if(0 == values[cell] && bits >= 2 && bits <= k)
+      {
+        masks[count] = candidates[cell];
+        positions[count++] = pos;
+      }
+    }
+
+    const unsigned int found = Subsets(masks, count, k, members, unions);
+
+    for(unsigned int s=0; s<found; ++s)
+    {
+      // the cells outside the subset lose its digits
+      Mask inside = 0;
+
+      for(unsigned int i=0; i<count; ++i)
+      {
+        if(members[s] & (Mask(1) << i))
+        {
+          inside |= static_cast<Mask>(Mask(1) << positions[i]);
+        }
+      }
+
+      for(unsigned int pos=0; pos<Size; ++pos)
+      {
+        if(0 == (inside & (Mask(1) << pos)) && !Remove(candidates, values, cells[pos], unions[s], changed))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::HiddenSubsets( const Tables & tables, Mask* candidates, const unsigned char* values, unsigned int k, bool & changed )
+{
+  CPlaces places;
+
+  Places(tables, candidates, values, places);
+
+  return HiddenSubsets(tables, candidates, values, places, k, changed);
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::HiddenSubsets( const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & positions, unsigned int k, bool & changed )
+{
+  const Mask (&places)[Units][Size] = positions.m_Places;
+  const Mask (&placed)[Units] = positions.m_Placed;
+  Mask masks[Size];
+  unsigned int digits[Size];
+  Mask members[Size];
+  Mask unions[Size];
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    unsigned int count = 0;
+
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      const unsigned int bits = PopCount(places[unit][digit]);
+
+      if(0 == (placed[unit] & (Mask(1) << digit)))
+      {
+        if(0 == bits)
+        {
+          return false;   // no place left for the digit
+        }
+
+        if(bits >= 2 && bits <= k)
+        {
+          masks[count] = places[unit][digit];
+          digits[count++] = digit;
+        }
+      }
+    }
+
+    const unsigned int found = Subsets(masks, count, k, members, unions);
+
+    for(unsigned int s=0; s<found; ++s)
+    {
+      // the cells of the subset keep nothing but its digits
+      Mask keep = 0;
+
+      for(unsigned int i=0; i<count; ++i)
+      {
+        if(members[s] & (Mask(1) << i))
+        {
+          keep |= static_cast<Mask>(Mask(1) << digits[i]);
+        }
+      }
+
+      for(Mask bits=unions[s]; 0 != bits; bits &= bits - 1)
+      {
+        if(!Remove(candidates, values, cells[LowestBit(bits)], static_cast<Mask>(~keep), changed))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::XWings( const Tables & tables, Mask* candidates, const unsigned char* values, bool & changed )
+{
+  CPlaces places;
+
+  Places(tables, candidates, values, places);
+
+  return XWings(tables, candidates, values, places, changed);
+}
+
+template <unsigned int Order>
+bool CLadder<Order>::XWings( const Tables & tables, Mask* candidates, const unsigned char* values, const CPlaces & positions, bool & changed )
+{
+  const Mask (&places)[Units][Size] = positions.m_Places;
+  unsigned int lines[Size];
+
+  // rows first, then columns, the positions along a row are its columns
+  for(unsigned int pass=0; pass<2; ++pass)
+  {
+    const bool columns = 1 == pass;
+    const unsigned int first = columns ? Size : 0;
+
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      const Mask bit = static_cast<Mask>(Mask(1) << digit);
+      unsigned int count = 0;
+
+      for(unsigned int line=0; line<Size; ++line)
+      {
+        if(2 == PopCount(places[first + line][digit]))
+        {
+          lines[count++] = line;
+        }
+      }
+
+      for(unsigned int a=0; a<count; ++a)
+      {
+        for(unsigned int b=a + 1; b<count; ++b)
+        {
+          const Mask wing = places[first + lines[a]][digit];
+
+          if(wing != places[first + lines[b]][digit])
+          {
+            continue;
+          }
+
+          // both crossing lines lose the digit everywhere else
+          for(unsigned int line=0; line<Size; ++line)
+          {
+            if(line == lines[a] || line == lines[b])
+            {
+              continue;
+            }
+
+            for(Mask bits=wing; 0 != bits; bits &= bits - 1)
+            {
+              if(!Remove(candidates, values, tables.m_Units[first + line][LowestBit(bits)], bit, changed))
+              {
+                return false;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CLadder_h__
@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "CLayoutReader.h"
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLayoutReader.cpp
+  \brief    Reads the region layout of jigsaw and diagonal variants.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+bool CLayoutReader::Read( std::istream & input, CGrid & layout )
+{
+  std::vector<std::string> rows;
+  bool diagonals = false;
+  std::string line;
+
+  while(std::getline(input, line))
+  {
+    // tolerate CR LF files and blanks around the symbols
+    const size_t begin = line.find_first_not_of(" \t\r");
+    const size_t end = line.find_last_not_of(" \t\r");
+
+    if(std::string::npos == begin || '#' == line[begin])
+    {
+      continue;
+    }
+
+    line = line.substr(begin, end - begin + 1);
+
+    if(line == "diagonals" || line == "DIAGONALS")
+    {
+      diagonals = true;
+    }
+    else
+    {
+      rows.push_back(line);
+    }
+  }
+
+  unsigned int order = 0;
+
+  for(unsigned int i=CGrid::MinOrder; i<=CGrid::MaxOrder; ++i)
+  {
+    if(rows.size() == i * i)
+    {
+      order = i;
+    }
+  }
+
+  if(0 == order || input.bad())
+  {
+    return false;
+  }
+
+  CGrid grid(order);
+  unsigned char regions[CGrid::MaxCells];
+  unsigned int sizes[CGrid::MaxSize] = {0};
+
+  for(unsigned int row=0; row<grid.Size(); ++row)
+  {
+    if(rows[row].size() != grid.Size())
+    {
+      return false;
+    }
+
+    for(unsigned int col=0; col<grid.Size(); ++col)
+    {
+      const unsigned int value = grid.Value(static_cast<unsigned char>(rows[row][col]));
+
+      if(0 == value || ++sizes[value - 1] > grid.Size())
+      {
+        return false;
+      }
+
+      regions[row * grid.Size() + col] = static_cast<unsigned char>(value - 1);
+    }
+  }
+
+  grid.SetRegions(regions);
+  grid.SetDiagonals(diagonals);
+  layout = grid;
+
+  return true;
+}
+
+bool CLayoutReader::Load( const wchar_t* path, CGrid & layout )
+{
+  std::ifstream file(path);
+
+  return file && Read(file, layout);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,70 @@
+#ifndef CLayoutReader_h__
+#define CLayoutReader_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLayoutReader.h
+  \brief    Reads the region layout of jigsaw and diagonal variants.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <iosfwd>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLayoutReader
+  \brief    Reads a layout description into an empty grid.
+
+  A description holds one line per row of the grid, each with the region
+  of every cell in the symbols of CGrid::Symbol(), so a jigsaw Hexadoku
+  has 16 lines of 16 symbols from 0 to F. The word "diagonals" makes both
+  main diagonals units as well, a diagonal variant lists the plain boxes
+  then. Empty lines and lines starting with '#' are skipped.
+
+  Each region has to hold as many cells as a row, otherwise the whole
+  description is rejected.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CLayoutReader
+{
+public:
+  //! reads a description, the grid gets its order, regions and diagonals but no givens
+  static bool Read(std::istream & input, CGrid & layout);
+
+  //! reads a description file, false if there is none or it is broken
+  static bool Load(const wchar_t* path, CGrid & layout);
+
+private:
+  CLayoutReader(); // not impl.
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CLayoutReader_h__
@@ -0,0 +1,973 @@
+#ifndef CLearningEngine_h__
+#define CLearningEngine_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLearningEngine.h
+  \brief    Backtracking search that learns nogoods from its conflicts.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include "CLadder.h"
+#include "CNogoodStore.h"
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLearningEngine
+  \brief    Searches a grid while learning from every conflict.
+
+  Each removed digit remembers the placed cell or the nogood that removed
+  it, and each placed cell whether it was decided, a naked single or a
+  hidden single. A conflict is traced back along these causes until a
+  single cell of the last decision level is left. That cell together
+  with the cells of lower levels the conflict depends on form a nogood:
+  their values cannot hold together.
+
+  The search then jumps back to the deepest of these lower levels, where
+  the nogood removes the digit of the remaining cell, and goes on from
+  there. Nogoods stay in force for the rest of the search, so the same
+  dead end is never walked into twice, however it is reached.
+
+  Only the first solution is looked for, a learned nogood may rule out
+  further ones.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CLearningEngine
+{
+public:
+  typedef CGridTraits<Order>      Traits;
+  typedef typename Traits::Mask   Mask;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells,
+    Units = Traits::Units
+  };
+
+  //! the complete search state of one level
+  struct CState
+  {
+    Mask          m_Candidates[Cells];  // remaining digits per cell
+    Mask          m_Units[Units];       // placed digits per row, column, region and diagonal
+    unsigned char m_Values[Cells];      // 0 = empty, else digit + 1
+    unsigned int  m_Placed;             // number of filled cells
+  };
+
+  CLearningEngine();
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  bool Solve(CGrid & grid);
+
+  //! writes the solution found by the last search into the grid
+  void Store(CGrid & grid) const;
+
+  //! stops the search once the flag is set or the node budget is used up (0 = no budget)
+  void SetLimits(const std::atomic<bool>* cancel, unsigned long budget);
+
+  //! true if the last search was stopped by SetLimits() or SetDeadline() before it finished
+  bool isAborted() const { return m_Aborted; }
+
+  //! stops the search once the flag is set or the deadline has passed, both looked at every few nodes only
+  void SetDeadline(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last search was stopped by SetDeadline()
+  bool isStopped() const { return m_Stopped; }
+
+  //! the number of search nodes visited by the last search
+  unsigned long Nodes() const { return m_Nodes; }
+
+  //! the nogoods learned by the last search
+  const CNogoodStore & Nogoods() const { return m_Nogoods; }
+
+private:
+  //! how a cell got its value
+  enum
+  {
+    Naked   = Units,      // below: hidden single of that unit
+    Decided = Units + 1,  // decisions and givens
+    ClockMask = 255       // nodes between two looks at the stop flag and the clock, minus one
+  };
+
+  //! what a failed propagation ran into
+  enum Conflict
+  {
+    EmptyCell,            // a cell without candidates
+    MissingDigit,         // a unit without a place for a digit
+    BrokenNogood          // a nogood whose literals all hold
+  };
+
+  CLearningEngine(const CLearningEngine &); // not impl.
+
+  //! selects the layout of the grid, places its givens into the first state and propagates them
+  bool Load(const CGrid & grid);
+
+  //! places a digit (0-based) and removes it from all peers and watching nogoods
+  bool Place(CState & state, unsigned int cell, unsigned int digit, unsigned short how);
+
+  //! removes a digit from a cell on behalf of a nogood
+  bool Remove(CState & state, unsigned int cell, unsigned int digit, uint32_t id);
+
+  //! visits the nogoods watching a literal that has just been placed
+  bool Watch(CState & state, uint32_t literal);
+
+  //! applies naked and hidden singles until nothing changes
+  bool Propagate(CState & state);
+
+  //! the unfilled cell with the fewest candidates
+  static unsigned int SelectCell(const CState & state);
+
+  //! searches below the given level, back is the level to resume at after a conflict
+  bool Search(unsigned int level, unsigned int & back);
+
+  //! learns a nogood from the conflict in the given state and returns the level it applies to
+  unsigned int Learn(const CState & state, unsigned int level);
+
+  //! removes the digit of the last nogood's remaining literal at the level it applies to
+  bool Assert(CState & state);
+
+  //! adds the cells behind the removal of a digit to the conflict
+  void Explain(unsigned int cell, unsigned int digit, unsigned int level);
+
+  //! adds the cells a placed cell was derived from to the conflict
+  void Explain(const CState & state, unsigned int cell, unsigned int level);
+
+  //! adds one placed cell to the conflict
+  void Mark(unsigned int cell, unsigned int level);
+
+  //! marks the nogoods still explaining a removal in the state
+  void Lock(const CState & state, std::vector<bool> & locked) const;
+
+  //! the literal of a digit in a cell as used by the nogood store
+  static uint32_t Literal(unsigned int cell, unsigned int digit) { return cell * Size + digit; }
+
+  CLayoutTables<Order>        m_Layout;     // units and peers of the loaded grid
+  std::vector<CState>         m_Stack;      // one state per search level
+  std::vector<unsigned short> m_Trail;      // placed cells in order
+  std::vector<unsigned int>   m_Marks;      // trail length at the end of each level
+  std::vector<unsigned int>   m_Queue;      // cells that became naked singles
+  std::vector<uint32_t>       m_Learned;    // cells, then literals of the nogood being learned
+  std::vector<bool>           m_Locked;
+  CNogoodStore                m_Nogoods;
+  uint32_t                    m_Asserting;  // the nogood to apply after jumping back
+  unsigned int                m_Level;      // the level placements are made at
+  Conflict                    m_Conflict;   // cause of the last failed propagation
+  unsigned int                m_Where;      // its cell, unit or nogood
+  unsigned int                m_Digit;      // its digit for a missing one
+  unsigned int                m_Pending;    // conflict cells of the last level not yet explained
+  unsigned int                m_Seen;       // generation of the marks below
+
+  // per cell, valid while the cell is placed on the current path
+  unsigned int                m_Levels[Cells];
+  unsigned int                m_Stamps[Cells];        // position on the trail
+  unsigned short              m_How[Cells];
+  unsigned int                m_Marked[Cells];        // generation the cell was added to the conflict
+
+  // per cell and digit, valid while the digit is removed on the current path
+  unsigned short              m_Source[Cells][Size];  // removing cell, Cells for the givens, above for a nogood
+
+  unsigned char               m_Solution[Cells];
+  unsigned long               m_Nodes;
+  unsigned long               m_Budget;
+  const std::atomic<bool>*    m_Cancel;
+  const std::atomic<bool>*    m_Stop;
+  std::chrono::steady_clock::time_point m_Deadline;
+  bool                        m_Aborted;
+  bool                        m_Stopped;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CLearningEngine implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CLearningEngine<Order>::CLearningEngine()
+  : m_Layout(),
+    m_Stack(),
+    m_Trail(),
+    m_Marks(),
+    m_Queue(),
+    m_Learned(),
+    m_Locked(),
+    m_Nogoods(Cells * Size),
+    m_Asserting(0),
+    m_Level(0),
+    m_Conflict(EmptyCell),
+    m_Where(0),
+    m_Digit(0),
+    m_Pending(0),
+    m_Seen(0),
+    m_Nodes(0UL),
+    m_Budget(0UL),
+    m_Cancel(NULL),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Aborted(false),
+    m_Stopped(false)
+{
+  m_Trail.reserve(Cells);
+  m_Queue.reserve(Cells);
+  memset(m_Marked, 0, sizeof(m_Marked));
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Solve( CGrid & grid )
+{
+  if(m_Stack.empty())
+  {
+    m_Stack.resize(Cells + 1);
+    m_Marks.resize(Cells + 1);
+  }
+
+  m_Nodes = 0UL;
+  m_Aborted = false;
+  m_Stopped = false;
+
+  unsigned int back = 0;
+
+  if(!Load(grid) || !Search(0, back))
+  {
+    return false;
+  }
+
+  Store(grid);
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Load( const CGrid & grid )
+{
+  if(grid.Order() != Order || !m_Layout.Select(grid))
+  {
+    return false;
+  }
+
+  CState & state = m_Stack[0];
+
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    state.m_Candidates[i] = Traits::AllDigits;
+    state.m_Values[i] = 0;
+
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      m_Source[i][digit] = static_cast<unsigned short>(Cells);
+    }
+  }
+
+  for(unsigned int i=0; i<Units; ++i)
+  {
+    state.m_Units[i] = 0;
+  }
+
+  state.m_Placed = 0;
+  m_Queue.clear();
+  m_Trail.clear();
+  m_Level = 0;
+
+  // nogoods only hold for the givens they were learned on
+  m_Nogoods.Clear();
+
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    const unsigned int value = grid.At(i);
+
+    if(value > Size || (0 != value && !Place(state, i, value - 1, Decided)))
+    {
+      m_Queue.clear();
+      return false;
+    }
+  }
+
+  if(!Propagate(state))
+  {
+    return false;
+  }
+
+  // removals on the first level need no cause, so the ladder can help out
+  CTrace trace;
+
+  while(Cells != state.m_Placed)
+  {
+    bool changed = false;
+
+    if(!CLadder<Order>::Step(*m_Layout, state.m_Candidates, state.m_Values, changed, trace))
+    {
+      return false;
+    }
+
+    if(!changed)
+    {
+      break;
+    }
+
+    for(unsigned int cell=0; cell<Cells; ++cell)
+    {
+      if(0 == state.m_Values[cell] && isSingle(state.m_Candidates[cell]))
+      {
+        m_Queue.push_back(cell);
+      }
+    }
+
+    if(!Propagate(state))
+    {
+      return false;
+    }
+  }
+
+  m_Marks[0] = static_cast<unsigned int>(m_Trail.size());
+
+  return true;
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::Store( CGrid & grid ) const
+{
+  for(unsigned int i=0; i<Cells; ++i)
+  {
+    grid.SetAt(i, m_Solution[i]);
+  }
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::SetLimits( const std::atomic<bool>* cancel, unsigned long budget )
+{
+  m_Cancel = cancel;
+  m_Budget = budget;
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::SetDeadline( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Place( CState & state, unsigned int cell, unsigned int digit, unsigned short how )
+{
+  const Mask bit = static_cast<Mask>(Mask(1) << digit);
+
+  if(0 != state.m_Values[cell] || 0 == (state.m_Candidates[cell] & bit))
+  {
+    // only givens contradicting each other get here
+    m_Conflict = EmptyCell;
+    m_Where = cell;
+    return false;
+  }
+
+  const unsigned short* const units = m_Layout->m_CellUnits[cell];
+
+  state.m_Values[cell] = static_cast<unsigned char>(digit + 1);
+  state.m_Candidates[cell] = bit;
+  ++state.m_Placed;
+
+  for(unsigned int k=0; k<m_Layout->m_UnitCount[cell]; ++k)
+  {
+    state.m_Units[units[k]] |= bit;
+  }
+
+  m_Levels[cell] = m_Level;
+  m_Stamps[cell] = static_cast<unsigned int>(m_Trail.size());
+  m_How[cell] = how;
+  m_Trail.push_back(static_cast<unsigned short>(cell));
+
+  const unsigned short* const peers = m_Layout->m_Peers[cell];
+  const unsigned int count = m_Layout->m_PeerCount[cell];
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    const unsigned int peer = peers[i];
+    Mask & candidates = state.m_Candidates[peer];
+
+    if(candidates & bit)
+    {
+      candidates &= ~bit;
+      m_Source[peer][digit] = static_cast<unsigned short>(cell);
+
+      if(0 == candidates)
+      {
+        m_Conflict = EmptyCell;
+        m_Where = peer;
+        return false;
+      }
+
+      if(isSingle(candidates))
+      {
+        m_Queue.push_back(peer);
+      }
+    }
+  }
+
+  return Watch(state, Literal(cell, digit));
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Remove( CState & state, unsigned int cell, unsigned int digit, uint32_t id )
+{
+  Mask & candidates = state.m_Candidates[cell];
+
+  candidates &= static_cast<Mask>(~(Mask(1) << digit));
+  m_Source[cell][digit] = static_cast<unsigned short>(Cells + 1 + id);
+
+  if(0 == candidates)
+  {
+    m_Conflict = EmptyCell;
+    m_Where = cell;
+    return false;
+  }
+
+  if(isSingle(candidates))
+  {
+    m_Queue.push_back(cell);
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Watch( CState & state, uint32_t literal )
+{
+  std::vector<uint32_t> & watchers = m_Nogoods.Watchers(literal);
+
+  for(size_t i=0; i<watchers.size(); )
+  {
+    const uint32_t id = watchers[i];
+    uint32_t* const literals = m_Nogoods.Literals(id);
+    const unsigned int length = m_Nogoods.Length(id);
+
+    if(1 == length)
+    {
+      m_Conflict = BrokenNogood;
+      m_Where = id;
+      return false;
+    }
+
+    // the placed literal goes second
+    if(literals[0] == literal)
+    {
+      literals[0] = literals[1];
+      literals[1] = literal;
+    }
+
+    const unsigned int cell = literals[0] / Size;
+    const unsigned int digit = literals[0] % Size;
+
+    // already kept from holding
+    if(0 == (state.m_Candidates[cell] & (Mask(1) << digit)))
+    {
+      ++i;
+      continue;
+    }
+
+    unsigned int k = 2;
+
+    for(; k<length; ++k)
+    {
+      if(state.m_Values[literals[k] / Size] != literals[k] % Size + 1)
+      {
+        break;
+      }
+    }
+
+    if(k < length)
+    {
+      // watch a literal that does not hold instead
+      literals[1] = literals[k];
+      literals[k] = literal;
+      m_Nogoods.Watchers(literals[1]).push_back(id);
+      watchers[i] = watchers.back();
+      watchers.pop_back();
+      continue;
+    }
+
+    if(0 != state.m_Values[cell])
+    {
+      m_Conflict = BrokenNogood;
+      m_Where = id;
+      return false;
+    }
+
+    if(!Remove(state, cell, digit, id))
+    {
+      return false;
+    }
+
+    ++i;
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Propagate( CState & state )
+{
+  bool changed = true;
+
+  while(changed)
+  {
+    while(!m_Queue.empty())
+    {
+      const unsigned int cell = m_Queue.back();
+      m_Queue.pop_back();
+
+      if(0 == state.m_Values[cell] && !Place(state, cell, LowestBit(state.m_Candidates[cell]), Naked))
+      {
+        m_Queue.clear();
+        return false;
+      }
+    }
+
+    if(Cells == state.m_Placed)
+    {
+      return true;
+    }
+
+    changed = false;
+
+    for(unsigned int unit=0; unit<m_Layout->m_UsedUnits; ++unit)
+    {
+      const Mask placed = state.m_Units[unit];
+
+      if(Traits::AllDigits == placed)
+      {
+        continue;
+      }
+
+      const unsigned short* const cells = m_Layout->m_Units[unit];
+      Mask once = 0;
+      Mask twice = 0;
+
+      for(unsigned int i=0; i<Size; ++i)
+      {
+        const unsigned int cell = cells[i];
+
+        if(0 == state.m_Values[cell])
+        {
+          const Mask candidates = state.m_Candidates[cell];
+          twice |= once & candidates;
+          once |= candidates;
+        }
+      }
+
+      const Mask missing = static_cast<Mask>(Traits::AllDigits & ~(once | placed));
+
+      if(0 != missing)
+      {
+        m_Conflict = MissingDigit;
+        m_Where = unit;
+        m_Digit = LowestBit(missing);
+        m_Queue.clear();
+        return false;
+      }
+
+      Mask hidden = once & ~twice;
+
+      while(0 != hidden)
+      {
+        const unsigned int digit = LowestBit(hidden);
+        const Mask bit = static_cast<Mask>(Mask(1) << digit);
+        hidden &= hidden - 1;
+
+        for(unsigned int i=0; i<Size; ++i)
+        {
+          const unsigned int cell = cells[i];
+
+          // an earlier hidden single of this unit may have taken the digit already
+          if(0 == state.m_Values[cell] && (state.m_Candidates[cell] & bit))
+          {
+            if(!Place(state, cell, digit, static_cast<unsigned short>(unit)))
+            {
+              m_Queue.clear();
+              return false;
+            }
+
+            changed = true;
+            break;
+          }
+        }
+      }
+    }
+
+    changed = changed || !m_Queue.empty();
+  }
+
+  return true;
+}
+
+template <unsigned int Order>
+unsigned int CLearningEngine<Order>::SelectCell( const CState & state )
+{
+  unsigned int best = Cells;
+  unsigned int bestCount = Size + 1;
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    if(0 == state.m_Values[cell])
+    {
+      const unsigned int count = PopCount(state.m_Candidates[cell]);
+
+      if(count < bestCount)
+      {
+        best = cell;
+        bestCount = count;
+
+        if(count <= 2)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Search( unsigned int level, unsigned int & back )
+{
+  CState & state = m_Stack[level];
+  CState & next = m_Stack[level + 1];
+
+  for(;;)
+  {
+    ++m_Nodes;
+
+    if(Cells == state.m_Placed)
+    {
+      memcpy(m_Solution, state.m_Values, sizeof(m_Solution));
+      return true;
+    }
+
+    if((0 != m_Budget && m_Nodes > m_Budget) ||
+       (NULL != m_Cancel && m_Cancel->load(std::memory_order_relaxed)))
+    {
+      m_Aborted = true;
+      return false;
+    }
+
+    if(0 == (m_Nodes & ClockMask))
+    {
+      m_Stopped = (NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+                  (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline);
+
+      if(m_Stopped)
+      {
+        m_Aborted = true;
+        return false;
+      }
+    }
+
+    const unsigned int cell = SelectCell(state);
+
+    next = state;
+    m_Trail.resize(m_Marks[level]);
+    m_Level = level + 1;
+
+    if(Place(next, cell, LowestBit(state.m_Candidates[cell]), Decided) && Propagate(next))
+    {
+      m_Marks[level + 1] = static_cast<unsigned int>(m_Trail.size());
+
+      if(Search(level + 1, back))
+      {
+        return true;
+      }
+
+      if(m_Aborted)
+      {
+        return false;
+      }
+    }
+    else
+    {
+      m_Queue.clear();
+      back = Learn(next, level + 1);
+    }
+
+    if(back < level)
+    {
+      return false;
+    }
+
+    // the new nogood rules out a digit on this level, which may fail as well
+    m_Trail.resize(m_Marks[level]);
+    m_Level = level;
+
+    if(!Assert(state))
+    {
+      m_Queue.clear();
+
+      if(0 != level)
+      {
+        back = Learn(state, level);
+      }
+
+      return false;
+    }
+
+    m_Marks[level] = static_cast<unsigned int>(m_Trail.size());
+  }
+}
+
+template <unsigned int Order>
+unsigned int CLearningEngine<Order>::Learn( const CState & state, unsigned int level )
+{
+  ++m_Seen;
+  m_Pending = 0;
+  m_Learned.clear();
+
+  // the cells the conflict depends on directly
+  switch(m_Conflict)
+  {
+  case EmptyCell:
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      Explain(m_Where, digit, level);
+    }
+    break;
+
+  case MissingDigit:
+    {
+      const unsigned short* const cells = m_Layout->m_Units[m_Where];
+
+      for(unsigned int i=0; i<Size; ++i)
+      {
+        if(0 != state.m_Values[cells[i]])
+        {
+          Mark(cells[i], level);
+        }
+        else
+        {
+          Explain(cells[i], m_Digit, level);
+        }
+      }
+    }
+    break;
+
+  case BrokenNogood:
+    {
+      const uint32_t* const literals = m_Nogoods.Literals(m_Where);
+
+      m_Nogoods.Bump(m_Where);
+
+      for(unsigned int k=0; k<m_Nogoods.Length(m_Where); ++k)
+      {
+        Mark(literals[k] / Size, level);
+      }
+    }
+    break;
+  }
+
+  // replaces the latest cells of the last level by their causes until one is left
+  unsigned int uip = Cells;
+
+  for(unsigned int pos=static_cast<unsigned int>(m_Trail.size()); pos-- > m_Marks[level - 1]; )
+  {
+    const unsigned int cell = m_Trail[pos];
+
+    if(m_Marked[cell] != m_Seen)
+    {
+      continue;
+    }
+
+    if(1 == m_Pending)
+    {
+      uip = cell;
+      break;
+    }
+
+    --m_Pending;
+    Explain(state, cell, level);
+  }
+
+  // the remaining cell goes first and the deepest other one second, those two are watched
+  unsigned int back = 0;
+
+  m_Learned.push_back(uip);
+
+  for(size_t k=0; k+1<m_Learned.size(); ++k)
+  {
+    if(m_Levels[m_Learned[k]] > back)
+    {
+      back = m_Levels[m_Learned[k]];
+      std::swap(m_Learned[k], m_Learned[0]);
+    }
+  }
+
+  std::swap(m_Learned[0], m_Learned.back());
+
+  if(m_Learned.size() > 1)
+  {
+    std::swap(m_Learned[1], m_Learned.back());
+  }
+
+  for(size_t k=0; k<m_Learned.size(); ++k)
+  {
+    m_Learned[k] = Literal(m_Learned[k], state.m_Values[m_Learned[k]] - 1);
+  }
+
+  if(m_Nogoods.isFull())
+  {
+    m_Locked.assign(m_Nogoods.Slots(), false);
+    Lock(m_Stack[back], m_Locked);
+    m_Nogoods.Prune(m_Locked);
+  }
+
+  m_Asserting = m_Nogoods.Add(m_Learned);
+
+  return back;
+}
+
+template <unsigned int Order>
+bool CLearningEngine<Order>::Assert( CState & state )
+{
+  const uint32_t literal = m_Nogoods.Literals(m_Asserting)[0];
+
+  return Remove(state, literal / Size, literal % Size, m_Asserting) && Propagate(state);
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::Explain( unsigned int cell, unsigned int digit, unsigned int level )
+{
+  const unsigned int source = m_Source[cell][digit];
+
+  if(source < Cells)
+  {
+    Mark(source, level);
+  }
+  else if(source > Cells)
+  {
+    const uint32_t id = source - Cells - 1;
+    const uint32_t* const literals = m_Nogoods.Literals(id);
+    const uint32_t removed = Literal(cell, digit);
+
+    m_Nogoods.Bump(id);
+
+    for(unsigned int k=0; k<m_Nogoods.Length(id); ++k)
+    {
+      if(literals[k] != removed)
+      {
+        Mark(literals[k] / Size, level);
+      }
+    }
+  }
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::Explain( const CState & state, unsigned int cell, unsigned int level )
+{
+  const unsigned int how = m_How[cell];
+  const unsigned int digit = state.m_Values[cell] - 1;
+
+  if(Naked == how)
+  {
+    for(unsigned int other=0; other<Size; ++other)
+    {
+      if(other != digit)
+      {
+        Explain(cell, other, level);
+      }
+    }
+  }
+  else if(how < Units)
+  {
+    // the digit had no other place in the unit
+    const unsigned short* const cells = m_Layout->m_Units[how];
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const unsigned int other = cells[i];
+
+      if(other == cell)
+      {
+        continue;
+      }
+
+      if(0 != state.m_Values[other] && m_Stamps[other] < m_Stamps[cell])
+      {
+        Mark(other, level);
+      }
+      else
+      {
+        Explain(other, digit, level);
+      }
+    }
+  }
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::Mark( unsigned int cell, unsigned int level )
+{
+  if(m_Marked[cell] == m_Seen || 0 == m_Levels[cell])
+  {
+    return;
+  }
+
+  m_Marked[cell] = m_Seen;
+
+  if(m_Levels[cell] == level)
+  {
+    ++m_Pending;
+  }
+  else
+  {
+    m_Learned.push_back(cell);
+  }
+}
+
+template <unsigned int Order>
+void CLearningEngine<Order>::Lock( const CState & state, std::vector<bool> & locked ) const
+{
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    for(unsigned int digit=0; digit<Size; ++digit)
+    {
+      const unsigned int source = m_Source[cell][digit];
+
+      if(source > Cells && 0 == (state.m_Candidates[cell] & (Mask(1) << digit)) && source - Cells - 1 < locked.size())
+      {
+        locked[source - Cells - 1] = true;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CLearningEngine_h__
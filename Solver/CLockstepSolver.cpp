@@ -0,0 +1,505 @@
+#include "stdafx.h"
+#include "CLockstepSolver.h"
+#include "BitOps.h"
+#include "CKernel16.h"
+#include <immintrin.h>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLockstepSolver.cpp
+  \brief    Propagates many puzzles at once, one per SIMD lane.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2 helpers, one register holds a cell of all lanes, the mask type picks the lane width
+
+SUDOKU_TARGET_AVX2 inline __m256i Broadcast(uint16_t m) { return _mm256_set1_epi16(static_cast<short>(m)); }
+SUDOKU_TARGET_AVX2 inline __m256i Broadcast(uint32_t m) { return _mm256_set1_epi32(static_cast<int>(m)); }
+SUDOKU_TARGET_AVX2 inline __m256i Broadcast(uint64_t m) { return _mm256_set1_epi64x(static_cast<long long>(m)); }
+
+//! all bits set in the lanes holding zero
+SUDOKU_TARGET_AVX2 inline __m256i IsZero(const __m256i & v, uint16_t) { return _mm256_cmpeq_epi16(v, _mm256_setzero_si256()); }
+SUDOKU_TARGET_AVX2 inline __m256i IsZero(const __m256i & v, uint32_t) { return _mm256_cmpeq_epi32(v, _mm256_setzero_si256()); }
+SUDOKU_TARGET_AVX2 inline __m256i IsZero(const __m256i & v, uint64_t) { return _mm256_cmpeq_epi64(v, _mm256_setzero_si256()); }
+
+//! the lowest bit of each lane cleared
+SUDOKU_TARGET_AVX2 inline __m256i ClearLowest(const __m256i & v, uint16_t) { return _mm256_and_si256(v, _mm256_sub_epi16(v, _mm256_set1_epi16(1))); }
+SUDOKU_TARGET_AVX2 inline __m256i ClearLowest(const __m256i & v, uint32_t) { return _mm256_and_si256(v, _mm256_sub_epi32(v, _mm256_set1_epi32(1))); }
+SUDOKU_TARGET_AVX2 inline __m256i ClearLowest(const __m256i & v, uint64_t) { return _mm256_and_si256(v, _mm256_sub_epi64(v, _mm256_set1_epi64x(1))); }
+
+SUDOKU_TARGET_AVX2 inline __m256i LoadLanes(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+SUDOKU_TARGET_AVX2 inline void StoreLanes(void* p, const __m256i & v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+
+//! one bit per lane holding anything but zero
+template <typename Mask>
+SUDOKU_TARGET_AVX2 inline uint32_t NonZeroLanes(const __m256i & v)
+{
+  const uint32_t zero = static_cast<uint32_t>(_mm256_movemask_epi8(IsZero(v, Mask())));
+  uint32_t lanes = 0;
+
+  for(unsigned int lane=0; lane<32 / sizeof(Mask); ++lane)
+  {
+    if(0 == (zero & (1U << (lane * sizeof(Mask)))))
+    {
+      lanes |= 1U << lane;
+    }
+  }
+
+  return lanes;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CLockstepEngine<Order>::CLockstepEngine()
+  : m_Layout(),
+    m_Used(0),
+    m_Failed(0)
+{
+  Clear();
+}
+
+template <unsigned int Order>
+void CLockstepEngine<Order>::Clear()
+{
+  // an empty lane has no candidates, so nothing changes in it
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    for(unsigned int lane=0; lane<Lanes; ++lane)
+    {
+      m_Candidates[cell][lane] = 0;
+    }
+  }
+
+  m_Used = 0;
+  m_Failed = 0;
+}
+
+template <unsigned int Order>
+void CLockstepEngine<Order>::Load( unsigned int lane, const CGrid & grid )
+{
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const unsigned int value = grid.At(cell);
+
+    m_Candidates[cell][lane] = 0 != value && value <= Size ? static_cast<Mask>(Mask(1) << (value - 1)) : Traits::AllDigits;
+  }
+
+  m_Used |= LaneMask(1) << lane;
+  m_Failed &= ~(LaneMask(1) << lane);
+}
+
+template <unsigned int Order>
+void CLockstepEngine<Order>::Exclude( unsigned int lane, unsigned int cell, unsigned int digit )
+{
+  m_Candidates[cell][lane] &= static_cast<Mask>(~(Mask(1) << (digit - 1)));
+}
+
+template <unsigned int Order>
+unsigned int CLockstepEngine<Order>::Propagate()
+{
+  const bool vectorized = CKernel16::isVectorized();
+  unsigned int sweeps = 0;
+  LaneMask changed = 0;
+
+  // a failed lane may go on changing, it is ignored from then on
+  do
+  {
+    LaneMask failed = 0;
+
+    if(vectorized)
+    {
+      SweepAvx2(changed, failed);
+    }
+    else
+    {
+      SweepScalar(changed, failed);
+    }
+
+    m_Failed |= failed & m_Used;
+    ++sweeps;
+  }
+  while(0 != (changed & m_Used & ~m_Failed));
+
+  return sweeps;
+}
+
+template <unsigned int Order>
+IVerifier::Verdict CLockstepEngine<Order>::Result( unsigned int lane ) const
+{
+  if(0 != (m_Failed & (LaneMask(1) << lane)))
+  {
+    return IVerifier::Contradictory;
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    if(!isSingle(m_Candidates[cell][lane]))
+    {
+      return IVerifier::Undecided;
+    }
+  }
+
+  return IVerifier::Unique;
+}
+
+template <unsigned int Order>
+void CLockstepEngine<Order>::Store( unsigned int lane, CGrid & grid ) const
+{
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const Mask candidates = m_Candidates[cell][lane];
+
+    grid.SetAt(cell, isSingle(candidates) ? LowestBit(candidates) + 1 : 0);
+  }
+}
+
+template <unsigned int Order>
+SUDOKU_TARGET_AVX2 void CLockstepEngine<Order>::SweepAvx2( LaneMask & changed, LaneMask & failed )
+{
+  const CGridTables<Order> & tables = *m_Layout;
+  const Mask width = 0;
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i all = Broadcast(static_cast<Mask>(Traits::AllDigits));
+
+  __m256i conflicts = zero;
+  __m256i missing = zero;
+  __m256i empty = zero;
+  __m256i diff = zero;
+  __m256i placed[CGridTables<Order>::Units];
+
+  // the digit of every single-candidate cell
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const __m256i v = LoadLanes(m_Candidates[cell]);
+    const __m256i single = _mm256_andnot_si256(IsZero(v, width), IsZero(ClearLowest(v, width), width));
+
+    StoreLanes(m_Digits[cell], _mm256_and_si256(v, single));
+  }
+
+  // the placed digits of each unit, a digit placed twice is a conflict
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    __m256i once = zero;
+    __m256i twice = zero;
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const __m256i d = LoadLanes(m_Digits[tables.m_Units[unit][i]]);
+
+      twice = _mm256_or_si256(twice, _mm256_and_si256(once, d));
+      once = _mm256_or_si256(once, d);
+    }
+
+    conflicts = _mm256_or_si256(conflicts, twice);
+    placed[unit] = once;
+  }
+
+  // naked singles, the placed digits leave the other cells of their units
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const __m256i v = LoadLanes(m_Candidates[cell]);
+    __m256i seen = zero;
+
+    for(unsigned int k=0; k<tables.m_UnitCount[cell]; ++k)
+    {
+      seen = _mm256_or_si256(seen, placed[tables.m_CellUnits[cell][k]]);
+    }
+
+    const __m256i n = _mm256_or_si256(LoadLanes(m_Digits[cell]), _mm256_andnot_si256(seen, v));
+
+    empty = _mm256_or_si256(empty, IsZero(n, width));
+    diff = _mm256_or_si256(diff, _mm256_xor_si256(n, v));
+    StoreLanes(m_Candidates[cell], n);
+  }
+
+  // hidden singles, a digit with one place left in a unit goes there
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    __m256i once = zero;
+    __m256i twice = zero;
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const __m256i n = LoadLanes(m_Candidates[cells[i]]);
+
+      twice = _mm256_or_si256(twice, _mm256_and_si256(once, n));
+      once = _mm256_or_si256(once, n);
+    }
+
+    missing = _mm256_or_si256(missing, _mm256_andnot_si256(once, all));
+
+    const __m256i unique = _mm256_andnot_si256(twice, once);
+
+    if(_mm256_testz_si256(unique, unique))
+    {
+      continue;
+    }
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const __m256i n = LoadLanes(m_Candidates[cells[i]]);
+      const __m256i h = _mm256_and_si256(n, unique);
+      const __m256i keep = IsZero(h, width);
+
+      // a cell holding two digits unique to the unit is a conflict
+      conflicts = _mm256_or_si256(conflicts, ClearLowest(h, width));
+
+      const __m256i m = _mm256_or_si256(_mm256_and_si256(keep, n), _mm256_andnot_si256(keep, h));
+
+      diff = _mm256_or_si256(diff, _mm256_xor_si256(m, n));
+      StoreLanes(m_Candidates[cells[i]], m);
+    }
+  }
+
+  changed = NonZeroLanes<Mask>(diff);
+  failed = NonZeroLanes<Mask>(_mm256_or_si256(_mm256_or_si256(conflicts, missing), empty));
+}
+
+template <unsigned int Order>
+void CLockstepEngine<Order>::SweepScalar( LaneMask & changed, LaneMask & failed )
+{
+  const CGridTables<Order> & tables = *m_Layout;
+
+  Mask conflicts[Lanes] = {0};
+  Mask missing[Lanes] = {0};
+  Mask empty[Lanes] = {0};
+  Mask diff[Lanes] = {0};
+  Mask placed[CGridTables<Order>::Units][Lanes];
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    for(unsigned int lane=0; lane<Lanes; ++lane)
+    {
+      const Mask v = m_Candidates[cell][lane];
+
+      m_Digits[cell][lane] = isSingle(v) ? v : 0;
+    }
+  }
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    Mask once[Lanes] = {0};
+    Mask twice[Lanes] = {0};
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const Mask* const d = m_Digits[tables.m_Units[unit][i]];
+
+      for(unsigned int lane=0; lane<Lanes; ++lane)
+      {
+        twice[lane] |= once[lane] & d[lane];
+        once[lane] |= d[lane];
+      }
+    }
+
+    for(unsigned int lane=0; lane<Lanes; ++lane)
+    {
+      conflicts[lane] |= twice[lane];
+      placed[unit][lane] = once[lane];
+    }
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    Mask seen[Lanes] = {0};
+
+    for(unsigned int k=0; k<tables.m_UnitCount[cell]; ++k)
+    {
+      const Mask* const p = placed[tables.m_CellUnits[cell][k]];
+
+      for(unsigned int lane=0; lane<Lanes; ++lane)
+      {
+        seen[lane] |= p[lane];
+      }
+    }
+
+    for(unsigned int lane=0; lane<Lanes; ++lane)
+    {
+      const Mask v = m_Candidates[cell][lane];
+      const Mask n = static_cast<Mask>(m_Digits[cell][lane] | (v & ~seen[lane]));
+
+      empty[lane] |= 0 == n ? 1 : 0;
+      diff[lane] |= n ^ v;
+      m_Candidates[cell][lane] = n;
+    }
+  }
+
+  for(unsigned int unit=0; unit<tables.m_UsedUnits; ++unit)
+  {
+    const unsigned short* const cells = tables.m_Units[unit];
+    Mask once[Lanes] = {0};
+    Mask twice[Lanes] = {0};
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      const Mask* const n = m_Candidates[cells[i]];
+
+      for(unsigned int lane=0; lane<Lanes; ++lane)
+      {
+        twice[lane] |= once[lane] & n[lane];
+        once[lane] |= n[lane];
+      }
+    }
+
+    for(unsigned int lane=0; lane<Lanes; ++lane)
+    {
+      missing[lane] |= Traits::AllDigits & ~once[lane];
+    }
+
+    for(unsigned int i=0; i<Size; ++i)
+    {
+      Mask* const n = m_Candidates[cells[i]];
+
+      for(unsigned int lane=0; lane<Lanes; ++lane)
+      {
+        const Mask h = n[lane] & ~twice[lane] & once[lane];
+
+        if(0 != h)
+        {
+          conflicts[lane] |= h & (h - 1);
+          diff[lane] |= n[lane] ^ h;
+          n[lane] = h;
+        }
+      }
+    }
+  }
+
+  changed = 0;
+  failed = 0;
+
+  for(unsigned int lane=0; lane<Lanes; ++lane)
+  {
+    if(0 != diff[lane])
+    {
+      changed |= LaneMask(1) << lane;
+    }
+
+    if(0 != (conflicts[lane] | missing[lane] | empty[lane]))
+    {
+      failed |= LaneMask(1) << lane;
+    }
+  }
+}
+
+template class CLockstepEngine<3>;
+template class CLockstepEngine<4>;
+template class CLockstepEngine<5>;
+template class CLockstepEngine<6>;
+
+//////////////////////////////////////////////////////////////////////////
+
+CLockstepSolver::CLockstepSolver()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36()
+{
+}
+
+unsigned int CLockstepSolver::Lanes( unsigned int order )
+{
+  switch(order)
+  {
+  case 3:   return CLockstepEngine<3>::Lanes;
+  case 4:   return CLockstepEngine<4>::Lanes;
+  case 5:   return CLockstepEngine<5>::Lanes;
+  case 6:   return CLockstepEngine<6>::Lanes;
+  default:  return 0;
+  }
+}
+
+unsigned int CLockstepSolver::Propagate( CGrid* const* grids, unsigned int count, IVerifier::Verdict* verdicts )
+{
+  if(0 == count)
+  {
+    return 0;
+  }
+
+  switch(grids[0]->Order())
+  {
+  case 3:   return PropagateWith(m_Engine9, grids, count, verdicts);
+  case 4:   return PropagateWith(m_Engine16, grids, count, verdicts);
+  case 5:   return PropagateWith(m_Engine25, grids, count, verdicts);
+  case 6:   return PropagateWith(m_Engine36, grids, count, verdicts);
+  default:  break;
+  }
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    verdicts[i] = IVerifier::Undecided;
+  }
+
+  return 0;
+}
+
+template <unsigned int Order>
+unsigned int CLockstepSolver::PropagateWith( CLockstepEngine<Order> & engine, CGrid* const* grids, unsigned int count, IVerifier::Verdict* verdicts )
+{
+  if(count > CLockstepEngine<Order>::Lanes || !engine.SetLayout(*grids[0]))
+  {
+    for(unsigned int i=0; i<count; ++i)
+    {
+      verdicts[i] = IVerifier::Undecided;
+    }
+
+    return 0;
+  }
+
+  engine.Clear();
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    engine.Load(i, *grids[i]);
+  }
+
+  const unsigned int sweeps = engine.Propagate();
+
+  for(unsigned int i=0; i<count; ++i)
+  {
+    verdicts[i] = engine.Result(i);
+
+    // the givens stay for the caller to report
+    if(IVerifier::Contradictory != verdicts[i])
+    {
+      engine.Store(i, *grids[i]);
+    }
+  }
+
+  return sweeps;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,152 @@
+#ifndef CLockstepSolver_h__
+#define CLockstepSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CLockstepSolver.h
+  \brief    Propagates many puzzles at once, one per SIMD lane.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "SolverTraits.h"
+#include "BitOps.h"
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLockstepEngine
+  \brief    Naked and hidden singles on a block of puzzles in lockstep.
+
+  The candidates of a cell in all puzzles of the block lie side by side,
+  so one 256 bit register holds a cell of 16 puzzles of up to 16x16, of
+  8 puzzles of 25x25 or of 4 puzzles of 36x36. Every sweep runs the same
+  register operations for all lanes, a lane that is already at its
+  fixpoint just does not change any more. Sweeps stop once no lane
+  changes.
+
+  Propagation alone solves most puzzles of a corpus and refutes most
+  removals of the generator. A lane left open needs branching, which
+  the caller does with the scalar engines, starting from the digits the
+  lane placed. All lanes share the layout given by SetLayout().
+
+  AVX2 is used if the processor supports it, otherwise a scalar version
+  computing the same results, see CKernel16::Vectorize().
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CLockstepEngine
+{
+public:
+  typedef CGridTraits<Order> Traits;
+  typedef typename Traits::Mask Mask;
+
+  enum
+  {
+    Size  = Traits::Size,
+    Cells = Traits::Cells,
+    Lanes = 32 / sizeof(Mask)     // of one 256 bit register
+  };
+
+  CLockstepEngine();
+  CLockstepEngine(const CLockstepEngine &); // not impl.
+
+  //! selects the units of the layout of the grid for all lanes, false if its regions are not all of Size cells
+  bool SetLayout(const CGrid & grid) { return m_Layout.Select(grid); }
+
+  //! empties all lanes
+  void Clear();
+
+  //! puts the givens of the grid into the lane
+  void Load(unsigned int lane, const CGrid & grid);
+
+  //! removes a digit from the candidates of a cell of the lane
+  void Exclude(unsigned int lane, unsigned int cell, unsigned int digit);
+
+  //! runs the sweeps until no lane changes, returns their number
+  unsigned int Propagate();
+
+  //! Unique if the lane is solved, Contradictory if it failed, Undecided if it needs branching
+  IVerifier::Verdict Result(unsigned int lane) const;
+
+  //! writes the digits placed in the lane into the grid, 0 for the open cells
+  void Store(unsigned int lane, CGrid & grid) const;
+
+private:
+  typedef uint32_t LaneMask;      // one bit per lane
+
+  //! one sweep with AVX2 registers
+  SUDOKU_TARGET_AVX2 void SweepAvx2(LaneMask & changed, LaneMask & failed);
+
+  //! one sweep computing the same lane by lane
+  void SweepScalar(LaneMask & changed, LaneMask & failed);
+
+  CLayoutTables<Order>  m_Layout;
+  Mask                  m_Candidates[Cells][Lanes];   // a cell of all lanes fills one register
+  Mask                  m_Digits[Cells][Lanes];       // the placed digit during a sweep, 0 for open cells
+  LaneMask              m_Used;                       // lanes loaded since Clear()
+  LaneMask              m_Failed;                     // lanes found contradictory
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLockstepSolver
+  \brief    Solves blocks of grids of one order and layout in lockstep.
+
+  The grids keep the digits placed by the propagation, so the ones left
+  Undecided only need the search of a scalar solver.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CLockstepSolver
+{
+public:
+  CLockstepSolver();
+  CLockstepSolver(const CLockstepSolver &); // not impl.
+
+  //! the number of grids of the order propagated together, 0 if the order is not supported
+  static unsigned int Lanes(unsigned int order);
+
+  //! propagates up to Lanes() grids of the same order and layout, returns the sweeps run
+  unsigned int Propagate(CGrid* const* grids, unsigned int count, IVerifier::Verdict* verdicts);
+
+private:
+  template <unsigned int Order>
+  static unsigned int PropagateWith(CLockstepEngine<Order> & engine, CGrid* const* grids, unsigned int count, IVerifier::Verdict* verdicts);
+
+  CLockstepEngine<3>  m_Engine9;
+  CLockstepEngine<4>  m_Engine16;
+  CLockstepEngine<5>  m_Engine25;
+  CLockstepEngine<6>  m_Engine36;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CLockstepSolver_h__
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "CNogoodStore.h"
+#include <algorithm>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CNogoodStore.cpp
+  \brief    Bounded store of learned nogoods.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+CNogoodStore::CNogoodStore( unsigned int literals )
+  : m_Nogoods(),
+    m_Free(),
+    m_Pool(),
+    m_Watchers(literals),
+    m_Count(0),
+    m_Learned(0UL),
+    m_Dropped(0UL)
+{
+  m_Nogoods.reserve(Capacity);
+}
+
+void CNogoodStore::Clear()
+{
+  for(size_t i=0; i<m_Pool.size(); ++i)
+  {
+    m_Watchers[m_Pool[i]].clear();
+  }
+
+  m_Nogoods.clear();
+  m_Free.clear();
+  m_Pool.clear();
+  m_Count = 0;
+  m_Learned = 0UL;
+  m_Dropped = 0UL;
+}
+
+uint32_t CNogoodStore::Add( const std::vector<uint32_t> & literals )
+{
+  CNogood nogood;
+  nogood.m_First = static_cast<uint32_t>(m_Pool.size());
+  nogood.m_Length = static_cast<unsigned int>(literals.size());
+  nogood.m_Activity = 1;
+
+  m_Pool.insert(m_Pool.end(), literals.begin(), literals.end());
+
+  uint32_t id = static_cast<uint32_t>(m_Nogoods.size());
+
+  if(m_Free.empty())
+  {
+    m_Nogoods.push_back(nogood);
+  }
+  else
+  {
+    id = m_Free.back();
+    m_Free.pop_back();
+    m_Nogoods[id] = nogood;
+  }
+
+  Watch(id);
+  ++m_Count;
+  ++m_Learned;
+
+  return id;
+}
+
+void CNogoodStore::Prune( const std::vector<bool> & locked )
+{
+  // the least active first, the longer one on a tie
+  std::vector< std::pair<unsigned int, uint32_t> > order;
+
+  for(uint32_t id=0; id<m_Nogoods.size(); ++id)
+  {
+    const CNogood & nogood = m_Nogoods[id];
+
+    if(0 != nogood.m_Length && !locked[id])
+    {
+      order.push_back(std::make_pair(nogood.m_Activity * 256 / (nogood.m_Length + 1), id));
+    }
+  }
+
+  const size_t drop = order.size() / 2;
+
+  std::nth_element(order.begin(), order.begin() + drop, order.end());
+
+  for(size_t i=0; i<drop; ++i)
+  {
+    m_Nogoods[order[i].second].m_Length = 0;
+    m_Free.push_back(order[i].second);
+  }
+
+  m_Count -= static_cast<unsigned int>(drop);
+  m_Dropped += static_cast<unsigned long>(drop);
+
+  // closes the gaps in the pool, the ids stay as they are
+  for(size_t i=0; i<m_Pool.size(); ++i)
+  {
+    m_Watchers[m_Pool[i]].clear();
+  }
+
+  std::vector<uint32_t> pool;
+  pool.reserve(m_Pool.size());
+
+  for(uint32_t id=0; id<m_Nogoods.size(); ++id)
+  {
+    CNogood & nogood = m_Nogoods[id];
+
+    if(0 != nogood.m_Length)
+    {
+      const uint32_t first = nogood.m_First;
+
+      nogood.m_First = static_cast<uint32_t>(pool.size());
+      nogood.m_Activity /= 2;
+      pool.insert(pool.end(), m_Pool.begin() + first, m_Pool.begin() + first + nogood.m_Length);
+    }
+  }
+
+  m_Pool.swap(pool);
+
+  for(uint32_t id=0; id<m_Nogoods.size(); ++id)
+  {
+    if(0 != m_Nogoods[id].m_Length)
+    {
+      Watch(id);
+    }
+  }
+}
+
+void CNogoodStore::Watch( uint32_t id )
+{
+  const uint32_t* const literals = Literals(id);
+
+  m_Watchers[literals[0]].push_back(id);
+
+  if(Length(id) > 1)
+  {
+    m_Watchers[literals[1]].push_back(id);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,131 @@
+#ifndef CNogoodStore_h__
+#define CNogoodStore_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CNogoodStore.h
+  \brief    Bounded store of learned nogoods.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CNogoodStore
+  \brief    Remembers sets of cell values that cannot hold together.
+
+  A literal stands for one digit in one cell, numbered cell * Size + digit.
+  A nogood is a set of literals that must not all hold. Each nogood
+  watches its first two literals: as long as neither holds, nothing can
+  follow from it, so it is only visited when one of them is placed. The
+  caller then swaps another literal that does not hold into the watched
+  position or, if there is none, removes the digit of the last one.
+
+  The store is bounded. Once it is full, the half of the nogoods taking
+  part in the fewest conflicts is dropped, except for those the caller
+  still needs to explain a removal. The counts of the rest are halved,
+  so nogoods that stopped paying off age out over time. Ids stay valid
+  until their nogood is dropped.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CNogoodStore
+{
+public:
+  enum
+  {
+    Capacity = 4096     // nogoods kept before pruning
+  };
+
+  //! construction for the given number of literals
+  explicit CNogoodStore(unsigned int literals);
+
+  //! forgets all nogoods
+  void Clear();
+
+  //! true once the next Add() needs a Prune() first
+  bool isFull() const { return m_Count >= Capacity; }
+
+  //! records a nogood watching its first two literals, returns its id
+  uint32_t Add(const std::vector<uint32_t> & literals);
+
+  //! drops the less active half of the nogoods whose id is not locked
+  void Prune(const std::vector<bool> & locked);
+
+  //! the literals of a nogood, the first two are watched
+  uint32_t* Literals(uint32_t id) { return &m_Pool[m_Nogoods[id].m_First]; }
+
+  //! the number of literals of a nogood
+  unsigned int Length(uint32_t id) const { return m_Nogoods[id].m_Length; }
+
+  //! the nogoods watching a literal
+  std::vector<uint32_t> & Watchers(uint32_t literal) { return m_Watchers[literal]; }
+
+  //! notes that a nogood took part in a conflict
+  void Bump(uint32_t id) { ++m_Nogoods[id].m_Activity; }
+
+  //! one more than the highest id in use
+  uint32_t Slots() const { return static_cast<uint32_t>(m_Nogoods.size()); }
+
+  //! the number of nogoods in the store
+  unsigned int Count() const { return m_Count; }
+
+  //! the number of nogoods recorded since the last Clear()
+  unsigned long Learned() const { return m_Learned; }
+
+  //! the number of nogoods dropped since the last Clear()
+  unsigned long Dropped() const { return m_Dropped; }
+
+private:
+  struct CNogood
+  {
+    uint32_t      m_First;      // position of the literals in the pool
+    unsigned int  m_Length;     // 0 for an unused id
+    unsigned int  m_Activity;   // conflicts taken part in, halved on each pruning
+  };
+
+  CNogoodStore(const CNogoodStore &); // not impl.
+  CNogoodStore & operator=(const CNogoodStore &); // not impl.
+
+  //! lists a nogood under its watched literals
+  void Watch(uint32_t id);
+
+  std::vector<CNogood>                  m_Nogoods;
+  std::vector<uint32_t>                 m_Free;       // unused ids
+  std::vector<uint32_t>                 m_Pool;       // literals of all nogoods
+  std::vector< std::vector<uint32_t> >  m_Watchers;   // nogoods watching each literal
+  unsigned int                          m_Count;
+  unsigned long                         m_Learned;
+  unsigned long                         m_Dropped;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CNogoodStore_h__
@@ -0,0 +1,182 @@
+#include "stdafx.h"
+#include "CParallelSolver.h"
+#include "CGridValidator.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CParallelSolver.cpp
+  \brief    Work-stealing parallel backtracking on top of the bitboard engine.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! one worker per hardware thread unless a count is given
+unsigned int WorkerCount( unsigned int threads )
+{
+  if(0 == threads)
+  {
+    threads = std::thread::hardware_concurrency();
+  }
+
+  return 0 != threads ? threads : 1;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CParallelSolver::CParallelSolver( unsigned int threads )
+  : m_Threads(WorkerCount(threads)),
+    m_Search9(m_Threads),
+    m_Search16(m_Threads),
+    m_Search25(m_Threads),
+    m_Search36(m_Threads),
+    m_Stats(),
+    m_Grid(),
+    m_Stopped(false)
+{
+}
+
+CParallelSolver::~CParallelSolver()
+{
+}
+
+const wchar_t* CParallelSolver::GetName() const
+{
+  return L"Parallel Bitboard";
+}
+
+bool CParallelSolver::Supports( unsigned int order ) const
+{
+  return order >= 3 && order <= 6;
+}
+
+const CSolveStats & CParallelSolver::Stats() const
+{
+  return m_Stats;
+}
+
+unsigned long CParallelSolver::Nodes() const
+{
+  return m_Stats.m_Nodes;
+}
+
+void CParallelSolver::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Search9.SetLimits(stop, deadline);
+  m_Search16.SetLimits(stop, deadline);
+  m_Search25.SetLimits(stop, deadline);
+  m_Search36.SetLimits(stop, deadline);
+}
+
+bool CParallelSolver::isStopped() const
+{
+  return m_Stopped;
+}
+
+void CParallelSolver::Partial( CGrid & grid ) const
+{
+  grid = m_Grid;
+
+  switch(m_Grid.Order())
+  {
+  case 3:
+    m_Search9.Partial(grid);
+    break;
+
+  case 4:
+    m_Search16.Partial(grid);
+    break;
+
+  case 5:
+    m_Search25.Partial(grid);
+    break;
+
+  case 6:
+    m_Search36.Partial(grid);
+    break;
+
+  default:
+    break;
+  }
+}
+
+bool CParallelSolver::Solve( CGrid & grid )
+{
+  // checked apart from the workers, a wrong solution counts as none
+  return 0 != Count(grid, 1, grid) && CGridValidator::isSolutionOf(grid, m_Grid);
+}
+
+unsigned int CParallelSolver::Count( const CGrid & grid, unsigned int limit, CGrid & first )
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  unsigned int found = 0;
+
+  m_Grid = grid;
+  m_Stopped = false;
+
+  switch(grid.Order())
+  {
+  case 3:
+    found = m_Search9.Count(grid, limit, first);
+    m_Stats = m_Search9.Stats();
+    m_Stopped = m_Search9.isStopped();
+    break;
+
+  case 4:
+    found = m_Search16.Count(grid, limit, first);
+    m_Stats = m_Search16.Stats();
+    m_Stopped = m_Search16.isStopped();
+    break;
+
+  case 5:
+    found = m_Search25.Count(grid, limit, first);
+    m_Stats = m_Search25.Stats();
+    m_Stopped = m_Search25.isStopped();
+    break;
+
+  case 6:
+    found = m_Search36.Count(grid, limit, first);
+    m_Stats = m_Search36.Stats();
+    m_Stopped = m_Search36.isStopped();
+    break;
+
+  default:
+    m_Stats.Clear();
+    break;
+  }
+
+  m_Stats.m_Backend = GetName();
+  m_Stats.m_Micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  return found;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
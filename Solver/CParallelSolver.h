@@ -0,0 +1,567 @@
+#ifndef CParallelSolver_h__
+#define CParallelSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CParallelSolver.h
+  \brief    Work-stealing parallel backtracking on top of the bitboard engine.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "CBitboardSolver.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CParallelSearch
+  \brief    Splits the search tree of one box order among worker threads.
+
+  A grid is first given to a single engine with a small node budget, so
+  easy grids never pay for starting threads. If the budget runs out, the
+  root state becomes the first task. A task above the split depth is
+  branched on its cell with the fewest candidates and its children are
+  pushed as new tasks, deeper tasks are searched to the end by the engine
+  of the worker.
+
+  Every worker owns a deque: it pushes and pops at the back, so it keeps
+  working depth first on its own subtree, while idle workers steal from
+  the front, where the shallowest and thus largest subtrees wait. Reaching
+  the wanted number of solutions sets the cancel flag every engine polls
+  once per node.
+
+  Solutions are counted into one atomic total shared by all engines, so
+  no worker keeps searching its own subtree for a second solution once
+  any other worker already found one.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CParallelSearch
+{
+public:
+  typedef CBitboardEngine<Order>    Engine;
+  typedef typename Engine::CState   CState;
+
+  explicit CParallelSearch(unsigned int threads);
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  bool Solve(CGrid & grid) { return 0 != Count(grid, 1, grid); }
+
+  //! counts the solutions of the grid up to the limit and keeps the first one found
+  unsigned int Count(const CGrid & grid, unsigned int limit, CGrid & first);
+
+  //! the number of search nodes visited by all workers during the last search
+  unsigned long Nodes() const { return m_Nodes; }
+
+  //! the number of tasks taken from other workers during the last search
+  unsigned long Steals() const { return m_Steals; }
+
+  //! the counters of all workers during the last search, merged
+  const CSolveStats & Stats() const { return m_Stats; }
+
+  //! gives up the search once the flag is set or the deadline has passed
+  void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last search was given up by the limits
+  bool isStopped() const { return m_Stopped; }
+
+  //! writes the fullest state any worker searched during the last search into the grid
+  void Partial(CGrid & grid) const;
+
+private:
+  enum
+  {
+    Budget = 2000   // nodes searched sequentially before going parallel
+  };
+
+  //! a subtree waiting to be searched
+  struct CTask
+  {
+    CState        m_State;
+    unsigned int  m_Depth;
+  };
+
+  //! the deque and engine owned by one thread
+  struct CWorker
+  {
+    std::mutex            m_Sync;
+    std::deque<CTask>     m_Tasks;
+    Engine                m_Engine;
+    std::vector<CState>   m_Children;
+    unsigned long         m_Nodes;
+    unsigned long         m_Steals;
+  };
+
+  //! adds a task at the back of the deque of the worker
+  void Push(CWorker & worker, const CState & state, unsigned int depth);
+
+  //! takes the newest task of the worker
+  bool Pop(CWorker & worker, CTask & task);
+
+  //! takes the oldest task of any other worker
+  bool Steal(unsigned int thief, CTask & task);
+
+  //! the loop of one worker thread
+  void Run(unsigned int index);
+
+  //! branches or searches one task
+  void Process(CWorker & worker, const CTask & task);
+
+  //! counts the solutions below a state with the engine of the worker
+  void Search(CWorker & worker, const CState & state);
+
+  //! keeps the first solution, cancels all workers once the limit is reached
+  void Publish(const Engine & engine);
+
+  std::vector<std::unique_ptr<CWorker> >  m_Workers;
+  unsigned int                            m_SplitDepth;   // tasks above are branched, not searched
+  std::atomic<bool>                       m_Done;         // enough solutions were found or the limits hit
+  std::atomic<bool>                       m_Stopped;      // the limits hit
+  const std::atomic<bool>*                m_Stop;
+  std::chrono::steady_clock::time_point   m_Deadline;
+  std::atomic<long>                       m_Pending;      // tasks pushed but not finished yet
+  std::atomic<unsigned int>               m_Found;        // solutions found by all workers
+  unsigned int                            m_Limit;
+  std::mutex                              m_ResultSync;
+  CGrid                                   m_Result;
+  bool                                    m_Solved;
+  unsigned long                           m_Nodes;
+  unsigned long                           m_Steals;
+  CSolveStats                             m_Stats;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CParallelSolver
+  \brief    Dispatches a grid to the parallel search of its box order.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CParallelSolver : public ISolver
+{
+public:
+  //! uses one worker per hardware thread if no count is given
+  explicit CParallelSolver(unsigned int threads = 0);
+  CParallelSolver(const CParallelSolver &); // not impl.
+  virtual ~CParallelSolver();
+
+  //! the name of the solver backend
+  virtual const wchar_t* GetName() const;
+
+  //! classic Sudokus, Hexadokus, 25x25 and 36x36 grids are supported
+  virtual bool Supports(unsigned int order) const;
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  virtual bool Solve(CGrid & grid);
+
+  //! counts the solutions of the grid up to the limit and keeps the first one found
+  unsigned int Count(const CGrid & grid, unsigned int limit, CGrid & first);
+
+  //! what the last call to Solve() or Count() did
+  virtual const CSolveStats & Stats() const;
+
+  //! stops Solve() and Count() once the flag is set or the deadline has passed
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last call to Solve() or Count() was stopped by the limits
+  virtual bool isStopped() const;
+
+  //! the fullest state any worker reached during the last call to Solve() or Count()
+  virtual void Partial(CGrid & grid) const;
+
+  //! the number of search nodes visited by the last call to Solve() or Count()
+  unsigned long Nodes() const;
+
+  //! the number of worker threads
+  unsigned int Threads() const { return m_Threads; }
+
+private:
+  unsigned int        m_Threads;
+  CParallelSearch<3>  m_Search9;
+  CParallelSearch<4>  m_Search16;
+  CParallelSearch<5>  m_Search25;
+  CParallelSearch<6>  m_Search36;
+  CSolveStats         m_Stats;
+  CGrid               m_Grid;       // the grid of the last search
+  bool                m_Stopped;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CParallelSearch implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CParallelSearch<Order>::CParallelSearch( unsigned int threads )
+  : m_Workers(),
+    m_SplitDepth(0),
+    m_Done(false),
+    m_Stopped(false),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Pending(0),
+    m_Found(0),
+    m_Limit(1),
+    m_ResultSync(),
+    m_Result(Order),
+    m_Solved(false),
+    m_Nodes(0UL),
+    m_Steals(0UL),
+    m_Stats()
+{
+  if(0 == threads)
+  {
+    threads = 1;
+  }
+
+  for(unsigned int i=0; i<threads; ++i)
+  {
+    m_Workers.push_back(std::unique_ptr<CWorker>(new CWorker()));
+
+    // hard 25x25 and 36x36 grids need far fewer nodes with it, smaller ones are faster without
+    m_Workers.back()->m_Engine.UseMatching(Order >= 5);
+  }
+
+  // enough shallow tasks to keep every worker busy, assuming about two children per branch
+  m_SplitDepth = 3;
+
+  for(unsigned int n=1; n<threads; n*=2)
+  {
+    ++m_SplitDepth;
+  }
+}
+
+template <unsigned int Order>
+unsigned int CParallelSearch<Order>::Count( const CGrid & grid, unsigned int limit, CGrid & first )
+{
+  CWorker & worker = *m_Workers[0];
+  CState root;
+
+  m_Nodes = 0UL;
+  m_Steals = 0UL;
+  m_Stopped = false;
+  m_Stats.Clear();
+  worker.m_Engine.ResetStats();
+
+  if(!worker.m_Engine.Load(grid, root))
+  {
+    m_Stats.Merge(worker.m_Engine.Stats());
+    return 0;
+  }
+
+  // cheap grids are done before any thread is started
+  worker.m_Engine.SetLimits(NULL, Budget);
+
+  unsigned int found = worker.m_Engine.Count(root, limit);
+
+  worker.m_Engine.SetLimits(NULL, 0UL);
+  m_Nodes = worker.m_Engine.Nodes();
+  m_Stats.Merge(worker.m_Engine.Stats());
+
+  if(worker.m_Engine.isStopped())
+  {
+    m_Stopped = true;
+    return 0;
+  }
+
+  if(!worker.m_Engine.isAborted())
+  {
+    if(0 != found)
+    {
+      worker.m_Engine.Store(first);
+    }
+
+    return found;
+  }
+
+  m_Done = false;
+  m_Pending = 0;
+  m_Found = 0;
+  m_Limit = limit;
+  m_Solved = false;
+  m_Result.SetLayout(grid);
+
+  for(size_t i=0; i<m_Workers.size(); ++i)
+  {
+    CWorker & w = *m_Workers[i];
+    w.m_Tasks.clear();
+    w.m_Engine.SetLimits(&m_Done, 0UL);
+    w.m_Engine.SetCounter(&m_Found);
+    w.m_Engine.ShareLayout(worker.m_Engine);
+    w.m_Engine.ResetStats();
+
+    if(i != 0)
+    {
+      w.m_Engine.ClearPartial();
+    }
+
+    w.m_Nodes = 0UL;
+    w.m_Steals = 0UL;
+  }
+
+  Push(worker, root, 0);
+
+  // the calling thread is the first worker
+  std::vector<std::thread> threads;
+
+  for(unsigned int i=1; i<m_Workers.size(); ++i)
+  {
+    threads.push_back(std::thread(&CParallelSearch::Run, this, i));
+  }
+
+  Run(0);
+
+  for(size_t i=0; i<threads.size(); ++i)
+  {
+    threads[i].join();
+  }
+
+  for(size_t i=0; i<m_Workers.size(); ++i)
+  {
+    CWorker & w = *m_Workers[i];
+    w.m_Engine.SetLimits(NULL, 0UL);
+    w.m_Engine.SetCounter(NULL);
+    m_Nodes += w.m_Nodes;
+    m_Steals += w.m_Steals;
+    m_Stats.Merge(w.m_Engine.Stats());
+  }
+
+  // the nodes branched into tasks were never searched by an engine
+  m_Stats.m_Nodes = m_Nodes;
+  m_Stats.m_Threads = static_cast<unsigned int>(m_Workers.size());
+
+  // engines stopped by the cancel flag may have counted past the limit
+  found = m_Found;
+
+  if(found > limit)
+  {
+    found = limit;
+  }
+
+  if(m_Solved)
+  {
+    first = m_Result;
+  }
+
+  return found;
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+
+  for(size_t i=0; i<m_Workers.size(); ++i)
+  {
+    m_Workers[i]->m_Engine.SetDeadline(stop, deadline);
+  }
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Partial( CGrid & grid ) const
+{
+  unsigned int best = 0;
+  CGrid state(grid);
+
+  for(size_t i=0; i<m_Workers.size(); ++i)
+  {
+    const unsigned int placed = m_Workers[i]->m_Engine.Partial(state);
+
+    if(placed > best)
+    {
+      grid = state;
+      best = placed;
+    }
+  }
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Push( CWorker & worker, const CState & state, unsigned int depth )
+{
+  CTask task;
+  task.m_State = state;
+  task.m_Depth = depth;
+
+  ++m_Pending;
+
+  std::lock_guard<std::mutex> lock(worker.m_Sync);
+  worker.m_Tasks.push_back(task);
+}
+
+template <unsigned int Order>
+bool CParallelSearch<Order>::Pop( CWorker & worker, CTask & task )
+{
+  std::lock_guard<std::mutex> lock(worker.m_Sync);
+
+  if(worker.m_Tasks.empty())
+  {
+    return false;
+  }
+
+  task = worker.m_Tasks.back();
+  worker.m_Tasks.pop_back();
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CParallelSearch<Order>::Steal( unsigned int thief, CTask & task )
+{
+  const size_t count = m_Workers.size();
+
+  for(size_t i=1; i<count; ++i)
+  {
+    CWorker & victim = *m_Workers[(thief + i) % count];
+    std::lock_guard<std::mutex> lock(victim.m_Sync);
+
+    if(!victim.m_Tasks.empty())
+    {
+      task = victim.m_Tasks.front();
+      victim.m_Tasks.pop_front();
+      ++m_Workers[thief]->m_Steals;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Run( unsigned int index )
+{
+  CWorker & worker = *m_Workers[index];
+  CTask task;
+
+  while(!m_Done)
+  {
+    // tasks below the clock interval of the engines never look at the limits themselves
+    if((NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+       (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline))
+    {
+      m_Stopped = true;
+      m_Done = true;
+      break;
+    }
+
+    if(Pop(worker, task) || Steal(index, task))
+    {
+      Process(worker, task);
+
+      // children were pushed before, so zero means the whole tree is done
+      --m_Pending;
+    }
+    else if(0 == m_Pending)
+    {
+      break;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Process( CWorker & worker, const CTask & task )
+{
+  if(m_Done)
+  {
+    return;
+  }
+
+  if(task.m_Depth >= m_SplitDepth)
+  {
+    Search(worker, task.m_State);
+    return;
+  }
+
+  worker.m_Children.clear();
+  worker.m_Engine.Branch(task.m_State, worker.m_Children);
+  ++worker.m_Nodes;
+
+  // pushed in reverse, so the worker continues with the lowest digit like the sequential search
+  for(size_t i=worker.m_Children.size(); i-- > 0; )
+  {
+    const CState & child = worker.m_Children[i];
+
+    if(Engine::isSolved(child))
+    {
+      Search(worker, child);
+    }
+    else
+    {
+      Push(worker, child, task.m_Depth + 1);
+    }
+  }
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Search( CWorker & worker, const CState & state )
+{
+  if(0 != worker.m_Engine.Count(state, m_Limit))
+  {
+    Publish(worker.m_Engine);
+  }
+
+  if(worker.m_Engine.isStopped())
+  {
+    m_Stopped = true;
+    m_Done = true;
+  }
+
+  worker.m_Nodes += worker.m_Engine.Nodes();
+}
+
+template <unsigned int Order>
+void CParallelSearch<Order>::Publish( const Engine & engine )
+{
+  std::lock_guard<std::mutex> lock(m_ResultSync);
+
+  if(!m_Solved)
+  {
+    engine.Store(m_Result);
+    m_Solved = true;
+  }
+
+  if(m_Found >= m_Limit)
+  {
+    m_Done = true;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CParallelSolver_h__
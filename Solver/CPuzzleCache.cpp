@@ -0,0 +1,200 @@
+#include "stdafx.h"
+#include "CPuzzleCache.h"
+#include "CCanonicalForm.h"
+#include <fstream>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CPuzzleCache.cpp
+  \brief    In-memory and on-disk cache of solved Sudokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! the symbols of all cells in one line
+std::string ToText( const CGrid & grid )
+{
+  std::string str(grid.Cells(), '.');
+
+  for(unsigned int i=0; i<grid.Cells(); ++i)
+  {
+    str[i] = static_cast<char>(grid.Symbol(grid.At(i)));
+  }
+
+  return str;
+}
+
+//! reads the cells of a line of symbols, false if its length fits no grid
+bool FromText( const std::string & str, CGrid & grid )
+{
+  for(unsigned int order=CGrid::MinOrder; order<=CGrid::MaxOrder; ++order)
+  {
+    if(str.size() == order * order * order * order)
+    {
+      grid = CGrid(order);
+
+      for(unsigned int i=0; i<grid.Cells(); ++i)
+      {
+        grid.SetAt(i, grid.Value(static_cast<unsigned char>(str[i])));
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CPuzzleCache::CPuzzleCache( const wchar_t* path )
+  : m_Path(NULL != path ? path : L""),
+    m_Entries()
+{
+  Load();
+}
+
+CPuzzleCache::~CPuzzleCache()
+{
+}
+
+bool CPuzzleCache::Lookup( CGrid & grid )
+{
+  // the symmetries of the canonical form break irregular regions and diagonals
+  if(!grid.isStandard())
+  {
+    return false;
+  }
+
+  const CCanonicalForm form(grid);
+  const Entries::const_iterator it = m_Entries.find(ToText(form.Grid()));
+  CGrid solution;
+
+  if(m_Entries.end() == it || !FromText(it->second, solution) || solution.Order() != grid.Order())
+  {
+    return false;
+  }
+
+  const CGrid result = form.FromCanonical(solution);
+
+  // a damaged file must not override the givens
+  for(unsigned int i=0; i<grid.Cells(); ++i)
+  {
+    if(0 == result.At(i) || (0 != grid.At(i) && grid.At(i) != result.At(i)))
+    {
+      return false;
+    }
+  }
+
+  grid = result;
+
+  return true;
+}
+
+void CPuzzleCache::Insert( const CGrid & givens, const CGrid & solution, const CSolveStats & /*stats*/ )
+{
+  if(!givens.isStandard())
+  {
+    return;
+  }
+
+  const CCanonicalForm form(givens);
+  const std::string key = ToText(form.Grid());
+
+  if(m_Entries.end() != m_Entries.find(key))
+  {
+    return;
+  }
+
+  const std::string value = ToText(form.ToCanonical(solution));
+
+  m_Entries[key] = value;
+
+  if(!m_Path.empty())
+  {
+    std::ofstream file(m_Path.c_str(), std::ios::app);
+
+    file << key << ' ' << value << '\n';
+  }
+}
+
+void CPuzzleCache::CopyTo( IPuzzleCache & target ) const
+{
+  const CSolveStats none;
+  CGrid givens;
+  CGrid solution;
+
+  for(Entries::const_iterator it=m_Entries.begin(); it!=m_Entries.end(); ++it)
+  {
+    if(FromText(it->first, givens) && FromText(it->second, solution) && solution.Order() == givens.Order())
+    {
+      target.Insert(givens, solution, none);
+    }
+  }
+}
+
+void CPuzzleCache::Load()
+{
+  if(m_Path.empty())
+  {
+    return;
+  }
+
+  std::ifstream file(m_Path.c_str());
+  std::string line;
+  CGrid grid;
+
+  while(std::getline(file, line))
+  {
+    const size_t split = line.find(' ');
+
+    if(std::string::npos == split)
+    {
+      continue;
+    }
+
+    const std::string key = line.substr(0, split);
+    std::string value = line.substr(split + 1);
+
+    if(!value.empty() && '\r' == value[value.size() - 1])
+    {
+      value.erase(value.size() - 1);
+    }
+
+    if(key.size() == value.size() && FromText(key, grid))
+    {
+      m_Entries[key] = value;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+#ifndef CPuzzleCache_h__
+#define CPuzzleCache_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CPuzzleCache.h
+  \brief    In-memory and on-disk cache of solved Sudokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <string>
+#include <unordered_map>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CPuzzleCache
+  \brief    Remembers solved Sudokus by the canonical form of their givens.
+
+  Grids that differ only by relabelled digits, transposition or swapped
+  bands and stacks share one entry, so a rescanned or rearranged puzzle
+  is answered without any search. Entries are kept in a hash map and,
+  if a file is given, appended to it as one line of canonical givens and
+  canonical solution each, in the symbols of the batch mode. The file is
+  read back on construction. Jigsaw and diagonal variants are not cached,
+  as most of these symmetries do not hold for them.
+
+  The application keeps its solved puzzles in a CPuzzleStore, files of
+  older versions are moved there with CopyTo().
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CPuzzleCache : public IPuzzleCache
+{
+public:
+  explicit CPuzzleCache(const wchar_t* path = NULL);
+  CPuzzleCache(const CPuzzleCache &); // not impl.
+  virtual ~CPuzzleCache();
+
+  //! fills the empty cells of the grid if its givens were solved before
+  virtual bool Lookup(CGrid & grid);
+
+  //! remembers the solution of the givens, the text file keeps no figures
+  virtual void Insert(const CGrid & givens, const CGrid & solution, const CSolveStats & stats);
+
+  //! inserts all entries into another cache
+  void CopyTo(IPuzzleCache & target) const;
+
+  //! the number of puzzles in the cache
+  size_t Count() const { return m_Entries.size(); }
+
+private:
+  typedef std::unordered_map<std::string, std::string> Entries;
+
+  //! reads the entries of the file, damaged lines are skipped
+  void Load();
+
+  std::wstring  m_Path;
+  Entries       m_Entries;  // canonical givens to canonical solution
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CPuzzleCache_h__
@@ -0,0 +1,640 @@
+#include "stdafx.h"
+#include "CPuzzleStore.h"
+#include "CCanonicalForm.h"
+#include <ctime>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CPuzzleStore.cpp
+  \brief    Memory-mapped database of solved Sudokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const char Magic[8] = { 'H', 'X', 'S', 'O', 'L', 'V', 'E', 'D' };
+
+enum
+{
+  Version       = 1,
+  InitialSlots  = 1 << 12,
+  Granularity   = 1 << 16   // the file grows in steps of at least this
+};
+
+//! the start of the file
+struct CHeader
+{
+  char      m_Magic[8];
+  uint32_t  m_Version;
+  uint32_t  m_Slots;        // of the index, a power of two
+  uint64_t  m_Count;        // of the records
+  uint64_t  m_End;          // of the last record
+  uint64_t  m_Reserved[4];
+};
+
+//! an entry of the index
+struct CSlot
+{
+  uint32_t  m_Hash;         // the upper half of the hash of the canonical givens
+  uint32_t  m_Record;       // offset of the record in units of 8 bytes, 0 if empty
+};
+
+//! a solved puzzle, followed by the bits of the givens and the digits of the solution
+struct CRecord
+{
+  uint64_t  m_Time;         // of the solve, seconds since 1970
+  uint32_t  m_Nodes;        // of the search, saturated
+  uint32_t  m_Micros;       // of the solve, saturated
+  uint16_t  m_Length;       // of the whole record
+  uint8_t   m_Order;
+  uint8_t   m_Threads;
+  char      m_Backend[12];  // not terminated if it fills all
+};
+
+//! the bytes of the bits marking the givens
+size_t MaskBytes( unsigned int order )
+{
+  return (order * order * order * order + 7) / 8;
+}
+
+//! the bytes of the solution, the 25 or 36 digits of larger grids do not fit a nibble
+size_t SolutionBytes( unsigned int order )
+{
+  const size_t cells = order * order * order * order;
+
+  return order <= 4 ? (cells + 1) / 2 : cells;
+}
+
+//! the bytes of a record of the order, a multiple of 8
+size_t RecordBytes( unsigned int order )
+{
+  return (sizeof(CRecord) + MaskBytes(order) + SolutionBytes(order) + 7) & ~static_cast<size_t>(7);
+}
+
+//! the offset of the first record behind an index of the slots
+uint64_t RecordStart( uint32_t slots )
+{
+  return sizeof(CHeader) + static_cast<uint64_t>(slots) * sizeof(CSlot);
+}
+
+//! the offset rounded up to the next step of the file size
+uint64_t RoundUp( uint64_t size )
+{
+  return (size + Granularity - 1) & ~static_cast<uint64_t>(Granularity - 1);
+}
+
+//! FNV-1a of the order and the cells of the canonical givens
+uint64_t Hash( const CGrid & givens )
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  hash = (hash ^ givens.Order()) * 1099511628211ULL;
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    hash = (hash ^ givens.At(i)) * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+//! writes the bits of the givens and the digits of the solution behind a record
+void Pack( const CGrid & givens, const CGrid & solution, unsigned char* data )
+{
+  const unsigned int order = givens.Order();
+  unsigned char* digits = data + MaskBytes(order);
+
+  memset(data, 0, MaskBytes(order) + SolutionBytes(order));
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    const unsigned int value = solution.At(i) - 1;
+
+    if(0 != givens.At(i))
+    {
+      data[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+    }
+
+    if(order <= 4)
+    {
+      digits[i / 2] |= static_cast<unsigned char>(value << (4 * (i % 2)));
+    }
+    else
+    {
+      digits[i] = static_cast<unsigned char>(value);
+    }
+  }
+}
+
+//! reads the givens and, if wanted, the solution of the record, false if it is damaged
+bool Unpack( const unsigned char* data, uint64_t available, CGrid & givens, CGrid* solution )
+{
+  // a damaged header may point close to the end of the view
+  if(available < sizeof(CRecord))
+  {
+    return false;
+  }
+
+  const CRecord & record = *reinterpret_cast<const CRecord*>(data);
+  const unsigned int order = record.m_Order;
+
+  if(order < CGrid::MinOrder || order > CGrid::MaxOrder || record.m_Length != RecordBytes(order) || available < record.m_Length)
+  {
+    return false;
+  }
+
+  const unsigned char* mask = data + sizeof(CRecord);
+  const unsigned char* digits = mask + MaskBytes(order);
+
+  givens = CGrid(order);
+
+  if(NULL != solution)
+  {
+    *solution = CGrid(order);
+  }
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    const unsigned int value = 1 + (order <= 4 ? (digits[i / 2] >> (4 * (i % 2))) & 0x0f : digits[i]);
+
+    if(value > givens.Size())
+    {
+      return false;
+    }
+
+    if(0 != (mask[i / 8] & (1 << (i % 8))))
+    {
+      givens.SetAt(i, value);
+    }
+
+    if(NULL != solution)
+    {
+      solution->SetAt(i, value);
+    }
+  }
+
+  return true;
+}
+
+//! true if both grids hold the same cells
+bool isEqual( const CGrid & a, const CGrid & b )
+{
+  if(a.Order() != b.Order())
+  {
+    return false;
+  }
+
+  for(unsigned int i=0; i<a.Cells(); ++i)
+  {
+    if(a.At(i) != b.At(i))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//! puts the record into the first empty slot from its hash on
+void Place( CSlot* slots, uint32_t count, uint64_t hash, uint64_t offset )
+{
+  size_t i = static_cast<size_t>(hash & (count - 1));
+
+  while(0 != slots[i].m_Record)
+  {
+    i = (i + 1) & (count - 1);
+  }
+
+  slots[i].m_Hash = static_cast<uint32_t>(hash >> 32);
+  slots[i].m_Record = static_cast<uint32_t>(offset / 8);
+}
+
+//! sets the size of an open file
+bool Resize( HANDLE file, uint64_t size )
+{
+  LARGE_INTEGER position;
+
+  position.QuadPart = static_cast<LONGLONG>(size);
+
+  return FALSE != SetFilePointerEx(file, position, NULL, FILE_BEGIN) && FALSE != SetEndOfFile(file);
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CPuzzleStore::CPuzzleStore( const wchar_t* path )
+  : m_Path(NULL != path ? path : L""),
+    m_File(INVALID_HANDLE_VALUE),
+    m_Mapping(NULL),
+    m_View(NULL),
+    m_Size(0),
+    m_Writable(false)
+{
+  if(!m_Path.empty())
+  {
+    Open();
+  }
+}
+
+CPuzzleStore::~CPuzzleStore()
+{
+  Close();
+}
+
+bool CPuzzleStore::Lookup( CGrid & grid )
+{
+  // the symmetries of the canonical form break irregular regions and diagonals
+  if(NULL == m_View || !grid.isStandard())
+  {
+    return false;
+  }
+
+  const CCanonicalForm form(grid);
+  const CGrid & key = form.Grid();
+  size_t slot = 0;
+
+  if(!Find(key, Hash(key), slot))
+  {
+    return false;
+  }
+
+  const uint64_t offset = static_cast<uint64_t>(reinterpret_cast<const CSlot*>(m_View + sizeof(CHeader))[slot].m_Record) * 8;
+  CGrid givens;
+  CGrid solution;
+
+  if(!Unpack(m_View + offset, End() - offset, givens, &solution))
+  {
+    return false;
+  }
+
+  const CGrid result = form.FromCanonical(solution);
+
+  // a damaged file must not override the givens
+  for(unsigned int i=0; i<grid.Cells(); ++i)
+  {
+    if(0 != grid.At(i) && grid.At(i) != result.At(i))
+    {
+      return false;
+    }
+  }
+
+  grid = result;
+
+  return true;
+}
+
+void CPuzzleStore::Insert( const CGrid & givens, const CGrid & solution, const CSolveStats & stats )
+{
+  if(NULL == m_View || !m_Writable || !givens.isStandard() || solution.Order() != givens.Order() || solution.CountGivens() != solution.Cells())
+  {
+    return;
+  }
+
+  const CCanonicalForm form(givens);
+  const CGrid & key = form.Grid();
+  const uint64_t hash = Hash(key);
+  size_t slot = 0;
+
+  if(Find(key, hash, slot))
+  {
+    return;
+  }
+
+  // at most half of the slots are used, so the probes stay short
+  if(2 * (reinterpret_cast<const CHeader*>(m_View)->m_Count + 1) > reinterpret_cast<const CHeader*>(m_View)->m_Slots)
+  {
+    const bool grown = Rehash();
+
+    if(NULL == m_View || (!grown && 4 * (reinterpret_cast<const CHeader*>(m_View)->m_Count + 1) > 3 * static_cast<uint64_t>(reinterpret_cast<const CHeader*>(m_View)->m_Slots)))
+    {
+      return;
+    }
+
+    Find(key, hash, slot);
+  }
+
+  const size_t bytes = RecordBytes(key.Order());
+
+  if(!Reserve(bytes))
+  {
+    return;
+  }
+
+  CHeader & header = *reinterpret_cast<CHeader*>(m_View);
+  CSlot* slots = reinterpret_cast<CSlot*>(m_View + sizeof(CHeader));
+
+  // the offsets of the index count in units of 8 bytes
+  if(header.m_End / 8 > 0xffffffffULL)
+  {
+    return;
+  }
+
+  CRecord & record = *reinterpret_cast<CRecord*>(m_View + header.m_End);
+
+  record.m_Time = static_cast<uint64_t>(std::time(NULL));
+  record.m_Nodes = static_cast<uint32_t>(stats.m_Nodes < 0xffffffffUL ? stats.m_Nodes : 0xffffffffUL);
+  record.m_Micros = static_cast<uint32_t>(stats.m_Micros < 4294967295.0 ? stats.m_Micros : 4294967295.0);
+  record.m_Length = static_cast<uint16_t>(bytes);
+  record.m_Order = static_cast<uint8_t>(key.Order());
+  record.m_Threads = static_cast<uint8_t>(stats.m_Threads < 255 ? stats.m_Threads : 255);
+
+  const wchar_t* backend = NULL != stats.m_Backend ? stats.m_Backend : L"";
+
+  for(size_t i=0; i<sizeof(record.m_Backend); ++i)
+  {
+    record.m_Backend[i] = static_cast<char>(*backend);
+    backend += 0 != *backend ? 1 : 0;
+  }
+
+  Pack(key, form.ToCanonical(solution), m_View + header.m_End + sizeof(CRecord));
+
+  // the record is complete before the index and the header point to it
+  slots[slot].m_Hash = static_cast<uint32_t>(hash >> 32);
+  slots[slot].m_Record = static_cast<uint32_t>(header.m_End / 8);
+  header.m_End += bytes;
+  ++header.m_Count;
+}
+
+size_t CPuzzleStore::Count() const
+{
+  return NULL != m_View ? static_cast<size_t>(reinterpret_cast<const CHeader*>(m_View)->m_Count) : 0;
+}
+
+bool CPuzzleStore::Open()
+{
+  m_Writable = true;
+  m_File = CreateFileW(m_Path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  // another process appends already, this one only reads
+  if(INVALID_HANDLE_VALUE == m_File)
+  {
+    m_Writable = false;
+    m_File = CreateFileW(m_Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  }
+
+  LARGE_INTEGER size;
+
+  if(INVALID_HANDLE_VALUE == m_File || !GetFileSizeEx(m_File, &size))
+  {
+    Close();
+    return false;
+  }
+
+  m_Size = static_cast<uint64_t>(size.QuadPart);
+
+  if(0 == m_Size && m_Writable)
+  {
+    m_Size = RoundUp(RecordStart(InitialSlots));
+
+    if(!Resize(m_File, m_Size) || !Map())
+    {
+      Close();
+      return false;
+    }
+
+    CHeader & header = *reinterpret_cast<CHeader*>(m_View);
+
+    header.m_Version = Version;
+    header.m_Slots = InitialSlots;
+    header.m_Count = 0;
+    header.m_End = RecordStart(InitialSlots);
+
+    // a file without its magic is never taken for a store
+    memcpy(header.m_Magic, Magic, sizeof(Magic));
+
+    return true;
+  }
+
+  if(m_Size < sizeof(CHeader) || !Map())
+  {
+    Close();
+    return false;
+  }
+
+  const CHeader & header = *reinterpret_cast<const CHeader*>(m_View);
+
+  if(0 != memcmp(header.m_Magic, Magic, sizeof(Magic)) || Version != header.m_Version || 0 == header.m_Slots || 0 != (header.m_Slots & (header.m_Slots - 1)) ||
+     RecordStart(header.m_Slots) > header.m_End || header.m_End > m_Size)
+  {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void CPuzzleStore::Close()
+{
+  Unmap();
+
+  if(INVALID_HANDLE_VALUE != m_File)
+  {
+    CloseHandle(m_File);
+    m_File = INVALID_HANDLE_VALUE;
+  }
+
+  m_Size = 0;
+}
+
+bool CPuzzleStore::Map()
+{
+  m_Mapping = CreateFileMappingW(m_File, NULL, m_Writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+
+  if(NULL == m_Mapping)
+  {
+    return false;
+  }
+
+  m_View = static_cast<unsigned char*>(MapViewOfFile(m_Mapping, m_Writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+
+  if(NULL == m_View)
+  {
+    Unmap();
+    return false;
+  }
+
+  return true;
+}
+
+void CPuzzleStore::Unmap()
+{
+  if(NULL != m_View)
+  {
+    UnmapViewOfFile(m_View);
+    m_View = NULL;
+  }
+
+  if(NULL != m_Mapping)
+  {
+    CloseHandle(m_Mapping);
+    m_Mapping = NULL;
+  }
+}
+
+bool CPuzzleStore::Reserve( uint64_t bytes )
+{
+  const uint64_t end = reinterpret_cast<const CHeader*>(m_View)->m_End;
+
+  if(end + bytes <= m_Size)
+  {
+    return true;
+  }
+
+  // half as much again, so the view is seldom mapped anew
+  const uint64_t size = RoundUp(end + bytes > m_Size + m_Size / 2 ? end + bytes : m_Size + m_Size / 2);
+
+  Unmap();
+
+  if(Resize(m_File, size))
+  {
+    m_Size = size;
+  }
+
+  if(!Map())
+  {
+    Close();
+    return false;
+  }
+
+  return end + bytes <= m_Size;
+}
+
+bool CPuzzleStore::Rehash()
+{
+  const CHeader & header = *reinterpret_cast<const CHeader*>(m_View);
+
+  if(header.m_Slots >= 0x80000000UL)
+  {
+    return false;
+  }
+
+  const uint32_t slots = header.m_Slots * 2;
+  const uint64_t first = RecordStart(header.m_Slots);
+  const uint64_t records = header.m_End - first;
+  const uint64_t size = RoundUp(RecordStart(slots) + records + Granularity);
+  const std::wstring temp = m_Path + L".new";
+
+  HANDLE file = CreateFileW(temp.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if(INVALID_HANDLE_VALUE == file)
+  {
+    return false;
+  }
+
+  HANDLE mapping = Resize(file, size) ? CreateFileMappingW(file, NULL, PAGE_READWRITE, 0, 0, NULL) : NULL;
+  unsigned char* view = NULL != mapping ? static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0)) : NULL;
+  bool done = NULL != view;
+
+  if(done)
+  {
+    CHeader & target = *reinterpret_cast<CHeader*>(view);
+    CSlot* index = reinterpret_cast<CSlot*>(view + sizeof(CHeader));
+    CGrid givens;
+
+    memcpy(view + RecordStart(slots), m_View + first, static_cast<size_t>(records));
+
+    target = header;
+    target.m_Slots = slots;
+    target.m_Count = 0;
+    target.m_End = RecordStart(slots);
+
+    // damaged records are dropped on the way
+    for(uint64_t offset=first; offset<header.m_End; offset+=reinterpret_cast<const CRecord*>(m_View + offset)->m_Length)
+    {
+      if(!Unpack(m_View + offset, header.m_End - offset, givens, NULL))
+      {
+        break;
+      }
+
+      Place(index, slots, Hash(givens), RecordStart(slots) + offset - first);
+      target.m_End = RecordStart(slots) + offset - first + reinterpret_cast<const CRecord*>(m_View + offset)->m_Length;
+      ++target.m_Count;
+    }
+
+    UnmapViewOfFile(view);
+  }
+
+  if(NULL != mapping)
+  {
+    CloseHandle(mapping);
+  }
+
+  CloseHandle(file);
+  Close();
+
+  // fails while another process still has the old file mapped
+  done = done && FALSE != MoveFileExW(temp.c_str(), m_Path.c_str(), MOVEFILE_REPLACE_EXISTING);
+
+  if(!done)
+  {
+    DeleteFileW(temp.c_str());
+  }
+
+  return Open() && done;
+}
+
+bool CPuzzleStore::Find( const CGrid & givens, uint64_t hash, size_t & slot ) const
+{
+  const CHeader & header = *reinterpret_cast<const CHeader*>(m_View);
+  const CSlot* slots = reinterpret_cast<const CSlot*>(m_View + sizeof(CHeader));
+  const size_t mask = header.m_Slots - 1;
+  const uint64_t end = End();
+  CGrid stored;
+
+  slot = static_cast<size_t>(hash & mask);
+
+  for(size_t probe=0; probe<=mask; ++probe, slot=(slot + 1) & mask)
+  {
+    const uint64_t offset = static_cast<uint64_t>(slots[slot].m_Record) * 8;
+
+    // an append that did not finish left a slot pointing behind the end
+    if(0 == slots[slot].m_Record || offset >= end)
+    {
+      return false;
+    }
+
+    if(static_cast<uint32_t>(hash >> 32) == slots[slot].m_Hash && Unpack(m_View + offset, end - offset, stored, NULL) && isEqual(stored, givens))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint64_t CPuzzleStore::End() const
+{
+  const uint64_t end = reinterpret_cast<const CHeader*>(m_View)->m_End;
+
+  return end < m_Size ? end : m_Size;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
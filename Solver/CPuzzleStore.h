@@ -0,0 +1,115 @@
+#ifndef CPuzzleStore_h__
+#define CPuzzleStore_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CPuzzleStore.h
+  \brief    Memory-mapped database of solved Sudokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <stdint.h>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CPuzzleStore
+  \brief    Keeps every solved Sudoku in a file mapped into memory.
+
+  Like CPuzzleCache a puzzle is found by the canonical form of its givens,
+  but nothing is parsed on startup: the file is mapped as it is and a
+  lookup probes an open addressing index at its start. Behind the index
+  each record holds the canonical solution two cells per byte (one from
+  25x25 on, whose digits need five bits), a bit per cell for the givens and
+  the figures of the solve that found it.
+
+  Only one process appends to the file, others that open it meanwhile
+  just read. Once half of the index is used the file is rewritten with
+  an index twice as large.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CPuzzleStore : public IPuzzleCache
+{
+public:
+  explicit CPuzzleStore(const wchar_t* path);
+  CPuzzleStore(const CPuzzleStore &); // not impl.
+  virtual ~CPuzzleStore();
+
+  //! fills the empty cells of the grid if its givens were solved before
+  virtual bool Lookup(CGrid & grid);
+
+  //! appends the solution of the givens and the figures of its solve
+  virtual void Insert(const CGrid & givens, const CGrid & solution, const CSolveStats & stats);
+
+  //! the number of puzzles in the store
+  size_t Count() const;
+
+  //! true if the file is open
+  bool isOpen() const { return NULL != m_View; }
+
+  //! true if this process appends to the file
+  bool isWritable() const { return m_Writable; }
+
+private:
+  //! opens and maps the file, starts a new one if it is empty
+  bool Open();
+
+  //! unmaps and closes the file
+  void Close();
+
+  //! maps all of the file, writable if this process appends
+  bool Map();
+
+  //! releases the view and the mapping
+  void Unmap();
+
+  //! grows the file if the bytes do not fit behind the last record
+  bool Reserve(uint64_t bytes);
+
+  //! rewrites the file with an index twice as large, false if it stays as it is
+  bool Rehash();
+
+  //! true if the canonical givens are stored, the slot holds them or the empty one to use
+  bool Find(const CGrid & givens, uint64_t hash, size_t & slot) const;
+
+  //! the end of the last record that is complete and mapped
+  uint64_t End() const;
+
+  std::wstring    m_Path;
+  void*           m_File;       // HANDLE of the file
+  void*           m_Mapping;    // HANDLE of its mapping
+  unsigned char*  m_View;       // all of the file, NULL if it is not open
+  uint64_t        m_Size;       // of the file and the view
+  bool            m_Writable;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CPuzzleStore_h__
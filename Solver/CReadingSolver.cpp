@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "CReadingSolver.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CReadingSolver.cpp
+  \brief    Picks the givens of a scan among the guesses of the recognizer.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CReadingSolver::CReadingSolver( float certain )
+  : m_Certain(certain),
+    m_Tried(0UL),
+    m_Corrected(),
+    m_Search9(),
+    m_Search16(),
+    m_Search25(),
+    m_Search36()
+{
+}
+
+CReadingSolver::~CReadingSolver()
+{
+}
+
+IVerifier::Verdict CReadingSolver::Resolve( const CReading & reading, CGrid & givens, CGrid & solution )
+{
+  IVerifier::Verdict verdict = IVerifier::Contradictory;
+
+  m_Tried = 0UL;
+  m_Corrected.clear();
+
+  if(reading.Order() != givens.Order())
+  {
+    return verdict;
+  }
+
+  switch(givens.Order())
+  {
+  case 3:
+    verdict = m_Search9.Resolve(reading, m_Certain, givens, solution);
+    m_Tried = m_Search9.Tried();
+    m_Corrected = m_Search9.Corrected();
+    break;
+
+  case 4:
+    verdict = m_Search16.Resolve(reading, m_Certain, givens, solution);
+    m_Tried = m_Search16.Tried();
+    m_Corrected = m_Search16.Corrected();
+    break;
+
+  case 5:
+    verdict = m_Search25.Resolve(reading, m_Certain, givens, solution);
+    m_Tried = m_Search25.Tried();
+    m_Corrected = m_Search25.Corrected();
+    break;
+
+  case 6:
+    verdict = m_Search36.Resolve(reading, m_Certain, givens, solution);
+    m_Tried = m_Search36.Tried();
+    m_Corrected = m_Search36.Corrected();
+    break;
+
+  default:
+    break;
+  }
+
+  return verdict;
+}
+
+void CReadingSolver::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Search9.SetLimits(stop, deadline);
+  m_Search16.SetLimits(stop, deadline);
+  m_Search25.SetLimits(stop, deadline);
+  m_Search36.SetLimits(stop, deadline);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,666 @@
+#ifndef CReadingSolver_h__
+#define CReadingSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CReadingSolver.h
+  \brief    Picks the givens of a scan among the guesses of the recognizer.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "CBitboardSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CReadingSearch
+  \brief    Tries the uncertain guesses of a reading for one box order.
+
+  Guesses at least as confident as the threshold are loaded as givens
+  right away. Every other cell with more than one guess is a branch point,
+  the least confident one first, and its guesses are assigned in their
+  order of confidence. A guess contradicting the guesses picked so far
+  cuts off every combination below it.
+
+  Combinations are tried with no guess but the most likely one first,
+  then with one misread, two and so on, so a single misread cell is found
+  before any combination with two. The first combination with exactly
+  one solution is taken.
+
+  If every combination contradicts, even a cell read with confidence may
+  be wrong. The givens most likely read are then repaired: a minimal set
+  of givens that still has no solution is cut out of them, and every
+  repair has to change one of its cells. Each cell of that conflict, and
+  each pair of it with a cell of the conflict left once it is dropped, is
+  tried in the order of the confidence of the digits read, the cheapest
+  first. A cell gets the other guesses of the recognizer before any
+  other digit.
+
+  The stop flag and the deadline are looked at before every combination
+  and every repair checked, a search cut short is Undecided.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CReadingSearch
+{
+public:
+  typedef CBitboardEngine<Order>    Engine;
+  typedef typename Engine::CState   CState;
+
+  CReadingSearch();
+  CReadingSearch(const CReadingSearch &); // not impl.
+
+  //! see CReadingSolver::Resolve()
+  IVerifier::Verdict Resolve(const CReading & reading, float certain, CGrid & givens, CGrid & solution);
+
+  //! see CReadingSolver::SetLimits()
+  void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! the number of combinations checked by the last call to Resolve()
+  unsigned long Tried() const { return m_Tried; }
+
+  //! the cells changed or emptied by the repair of the last call to Resolve()
+  const std::vector<unsigned int> & Corrected() const { return m_Corrected; }
+
+private:
+  enum
+  {
+    MaxMisreads = 3,      // cells not read as their most likely guess
+    MaxTried    = 4096,   // combinations checked per reading
+    MaxRepairs  = 1024,   // givens checked by the repair on top of these
+    Budget      = 20000   // search nodes per combination
+  };
+
+  //! a set of cells to correct, or all pairs of a cell with the conflict left without it
+  struct CRepair
+  {
+    float         m_Cost;       // the confidence of the digits read, a lower bound for pairs not yet listed
+    unsigned int  m_Cells[2];
+    unsigned int  m_Count;      // 0 if the pairs of m_Cells[0] are still to be listed
+  };
+
+  //! picks the guesses from the uncertain cell with the index on, using up exactly the given misreads
+  bool Search(unsigned int index, unsigned int misreads);
+
+  //! counts the solutions of a complete combination, true if there is exactly one
+  bool Check(const CState & state);
+
+  //! writes the guesses of a combination into the givens
+  void Pick(const std::vector<unsigned char> & ranks, CGrid & givens) const;
+
+  //! corrects the fewest and least confident givens until there is exactly one solution
+  bool Repair(CGrid & givens, CGrid & solution);
+
+  //! shrinks givens without any solution to a subset that only has one if any of its cells is dropped
+  void Conflict(const CGrid & givens, std::vector<unsigned int> & cells);
+
+  //! gives the cells new digits, or none, so that the givens have exactly one solution
+  bool Correct(CGrid & givens, const unsigned int* cells, unsigned int count, CGrid & solution);
+
+  //! tries the digits of the cells from the index on, true once the givens have exactly one solution
+  bool Relabel(CGrid & givens, const unsigned int* cells, unsigned int count, unsigned int index, CGrid & solution);
+
+  //! the solutions of the givens up to two, 3 if the budget ran out
+  unsigned int Solutions(const CGrid & givens, CGrid* solution);
+
+  //! how sure the recognizer was about the digit read in the cell
+  float Cost(unsigned int cell) const;
+
+  //! inserts a repair behind all cheaper ones
+  static void Enqueue(std::vector<CRepair> & queue, const CRepair & repair);
+
+  //! true once the stop flag is set or the deadline has passed, stays so until the next Resolve()
+  bool isExpired();
+
+  Engine                      m_Engine;
+  const CReading*             m_Reading;
+  std::vector<unsigned int>   m_Uncertain;  // cells to branch on, least confident first
+  std::vector<CState>         m_States;     // the state before each uncertain cell
+  std::vector<unsigned char>  m_Ranks;      // the guess picked per uncertain cell
+  std::vector<unsigned char>  m_Ambiguous;  // the first combination with several solutions
+  CGrid                       m_First;      // a solution of that combination
+  std::vector<unsigned int>   m_Corrected;  // by the repair
+  bool                        m_hasAmbiguous;
+  unsigned long               m_Tried;
+  unsigned long               m_Repairs;    // checks left to the repair
+  const std::atomic<bool>*    m_Stop;
+  std::chrono::steady_clock::time_point m_Deadline;
+  bool                        m_Stopped;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CReadingSolver
+  \brief    Dispatches a reading to the search of its box order.
+
+  Trying the guesses of the recognizer resolves most misreads without
+  asking the operator for another scan.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CReadingSolver
+{
+public:
+  //! guesses at least as confident as the threshold are taken as read
+  explicit CReadingSolver(float certain = 0.9f);
+  CReadingSolver(const CReadingSolver &); // not impl.
+  ~CReadingSolver();
+
+  //! picks one guess per cell so that the givens have exactly one solution;
+  //! the givens have to carry the layout of the grid read and get the guesses
+  //! picked, Ambiguous or Contradictory if no combination tried had one solution,
+  //! Undecided if the limits stopped it first
+  IVerifier::Verdict Resolve(const CReading & reading, CGrid & givens, CGrid & solution);
+
+  //! stops Resolve() once the flag is set or the deadline has passed, it is Undecided then
+  void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! the number of combinations checked by the last call to Resolve()
+  unsigned long Tried() const { return m_Tried; }
+
+  //! the cells the last call to Resolve() had to change or empty although the recognizer offered nothing else
+  const std::vector<unsigned int> & Corrected() const { return m_Corrected; }
+
+private:
+  float               m_Certain;
+  unsigned long       m_Tried;
+  std::vector<unsigned int> m_Corrected;
+  CReadingSearch<3>   m_Search9;
+  CReadingSearch<4>   m_Search16;
+  CReadingSearch<5>   m_Search25;
+  CReadingSearch<6>   m_Search36;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// CReadingSearch implementation
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+CReadingSearch<Order>::CReadingSearch()
+  : m_Engine(),
+    m_Reading(NULL),
+    m_Uncertain(),
+    m_States(),
+    m_Ranks(),
+    m_Ambiguous(),
+    m_First(Order),
+    m_Corrected(),
+    m_hasAmbiguous(false),
+    m_Tried(0UL),
+    m_Repairs(0UL),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Stopped(false)
+{
+}
+
+template <unsigned int Order>
+IVerifier::Verdict CReadingSearch<Order>::Resolve( const CReading & reading, float certain, CGrid & givens, CGrid & solution )
+{
+  m_Reading = &reading;
+  m_Uncertain.clear();
+  m_Corrected.clear();
+  m_hasAmbiguous = false;
+  m_Tried = 0UL;
+  m_Stopped = false;
+
+  givens.Clear();
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    const unsigned int count = reading.Glyphs(i);
+
+    if(0 == count)
+    {
+      continue;
+    }
+
+    const float confidence = reading.Glyph(i, 0).m_Confidence;
+
+    if(1 == count || confidence >= certain)
+    {
+      givens.SetAt(i, reading.Glyph(i, 0).m_Value);
+      continue;
+    }
+
+    // least confident first, these are the likeliest misreads
+    size_t pos = m_Uncertain.size();
+    m_Uncertain.push_back(i);
+
+    for(; pos > 0 && reading.Glyph(m_Uncertain[pos - 1], 0).m_Confidence > confidence; --pos)
+    {
+      m_Uncertain[pos] = m_Uncertain[pos - 1];
+    }
+
+    m_Uncertain[pos] = i;
+  }
+
+  m_States.resize(m_Uncertain.size() + 1);
+  m_Ranks.assign(m_Uncertain.size(), 0);
+  solution = givens;
+
+  if(!m_Engine.Load(givens, m_States[0]))
+  {
+    Pick(m_Ranks, givens);
+    return Repair(givens, solution) ? IVerifier::Unique : m_Stopped ? IVerifier::Undecided : IVerifier::Contradictory;
+  }
+
+  for(unsigned int misreads=0; misreads<=MaxMisreads && misreads<=m_Uncertain.size(); ++misreads)
+  {
+    if(Search(0, misreads))
+    {
+      Pick(m_Ranks, givens);
+      m_Engine.Store(solution);
+      return IVerifier::Unique;
+    }
+  }
+
+  // a later combination might have had one solution
+  if(m_Stopped)
+  {
+    Pick(m_Ranks, givens);
+    solution = givens;
+    return IVerifier::Undecided;
+  }
+
+  if(m_hasAmbiguous)
+  {
+    Pick(m_Ambiguous, givens);
+    solution = m_First;
+    solution.SetLayout(givens);
+    return IVerifier::Ambiguous;
+  }
+
+  Pick(m_Ranks, givens);
+  solution = givens;
+
+  return Repair(givens, solution) ? IVerifier::Unique : m_Stopped ? IVerifier::Undecided : IVerifier::Contradictory;
+}
+
+template <unsigned int Order>
+void CReadingSearch<Order>::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+
+  // a single combination ends in time as well
+  m_Engine.SetDeadline(stop, deadline);
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::Search( unsigned int index, unsigned int misreads )
+{
+  if(index == m_Uncertain.size())
+  {
+    return 0 == misreads && Check(m_States[index]);
+  }
+
+  // every misread needs a cell of its own
+  if(misreads > m_Uncertain.size() - index || m_Tried >= MaxTried || isExpired())
+  {
+    return false;
+  }
+
+  const unsigned int cell = m_Uncertain[index];
+  const unsigned int count = 0 != misreads ? m_Reading->Glyphs(cell) : 1;
+
+  for(unsigned int rank=0; rank<count; ++rank)
+  {
+    const unsigned int value = m_Reading->Glyph(cell, rank).m_Value;
+    CState & next = m_States[index + 1];
+
+    next = m_States[index];
+
+    // an empty cell adds nothing, a contradicting digit cuts off all combinations below
+    if(0 != value && !m_Engine.Assign(next, cell, value))
+    {
+      continue;
+    }
+
+    m_Ranks[index] = static_cast<unsigned char>(rank);
+
+    if(Search(index + 1, 0 != rank ? misreads - 1 : misreads))
+    {
+      return true;
+    }
+  }
+
+  m_Ranks[index] = 0;
+
+  return false;
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::Check( const CState & state )
+{
+  ++m_Tried;
+
+  m_Engine.SetLimits(NULL, Budget);
+
+  const unsigned int found = m_Engine.Count(state, 2);
+
+  m_Engine.SetLimits(NULL, 0UL);
+
+  // a second solution counts even if the budget ran out later
+  if(found > 1 && !m_hasAmbiguous)
+  {
+    m_Ambiguous = m_Ranks;
+    m_Engine.Store(m_First);
+    m_hasAmbiguous = true;
+  }
+
+  return 1 == found && !m_Engine.isAborted();
+}
+
+template <unsigned int Order>
+void CReadingSearch<Order>::Pick( const std::vector<unsigned char> & ranks, CGrid & givens ) const
+{
+  for(size_t k=0; k<m_Uncertain.size(); ++k)
+  {
+    givens.SetAt(m_Uncertain[k], m_Reading->Glyph(m_Uncertain[k], ranks[k]).m_Value);
+  }
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::Repair( CGrid & givens, CGrid & solution )
+{
+  std::vector<unsigned int> conflict;
+  std::vector<unsigned int> tested;   // pairs as first * Cells + second
+  std::vector<CRepair> queue;
+  float cheapest = 1.0f;
+
+  m_Repairs = MaxRepairs;
+  Conflict(givens, conflict);
+
+  for(unsigned int i=0; i<givens.Cells(); ++i)
+  {
+    if(0 != givens.At(i) && Cost(i) < cheapest)
+    {
+      cheapest = Cost(i);
+    }
+  }
+
+  // every repair changes a cell of the conflict, a pair costs at least the cheapest given more
+  for(size_t k=0; k<conflict.size(); ++k)
+  {
+    const CRepair single = { Cost(conflict[k]), { conflict[k], 0 }, 1 };
+    const CRepair pairs = { Cost(conflict[k]) + cheapest, { conflict[k], 0 }, 0 };
+
+    Enqueue(queue, single);
+    Enqueue(queue, pairs);
+  }
+
+  while(!queue.empty() && 0UL != m_Repairs && !isExpired())
+  {
+    const CRepair repair = queue.front();
+
+    queue.erase(queue.begin());
+
+    if(0 != repair.m_Count)
+    {
+      // a pair may be listed from both of its cells
+      const unsigned int key = std::min(repair.m_Cells[0], repair.m_Cells[1]) * givens.Cells() + std::max(repair.m_Cells[0], repair.m_Cells[1]);
+
+      if(2 == repair.m_Count && std::find(tested.begin(), tested.end(), key) != tested.end())
+      {
+        continue;
+      }
+
+      if(2 == repair.m_Count)
+      {
+        tested.push_back(key);
+      }
+
+      if(Correct(givens, repair.m_Cells, repair.m_Count, solution))
+      {
+        m_Corrected.assign(repair.m_Cells, repair.m_Cells + repair.m_Count);
+        return true;
+      }
+
+      continue;
+    }
+
+    // the second cell has to break the conflict left without the first one
+    CGrid rest(givens);
+
+    rest.SetAt(repair.m_Cells[0], 0);
+
+    if(0 != Solutions(rest, NULL))
+    {
+      continue;
+    }
+
+    Conflict(rest, conflict);
+
+    for(size_t k=0; k<conflict.size(); ++k)
+    {
+      const CRepair pair = { Cost(repair.m_Cells[0]) + Cost(conflict[k]), { repair.m_Cells[0], conflict[k] }, 2 };
+
+      Enqueue(queue, pair);
+    }
+  }
+
+  return false;
+}
+
+template <unsigned int Order>
+void CReadingSearch<Order>::Conflict( const CGrid & givens, std::vector<unsigned int> & cells )
+{
+  CGrid rest(givens);
+
+  cells.clear();
+
+  // a given stays only if the rest would have a solution without it
+  for(unsigned int i=0; i<rest.Cells(); ++i)
+  {
+    const unsigned int value = rest.At(i);
+
+    if(0 == value)
+    {
+      continue;
+    }
+
+    rest.SetAt(i, 0);
+
+    if(0 != Solutions(rest, NULL))
+    {
+      rest.SetAt(i, value);
+      cells.push_back(i);
+    }
+  }
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::Correct( CGrid & givens, const unsigned int* cells, unsigned int count, CGrid & solution )
+{
+  CGrid trial(givens);
+
+  for(unsigned int k=0; k<count; ++k)
+  {
+    trial.SetAt(cells[k], 0);
+  }
+
+  const unsigned int found = Solutions(trial, &solution);
+
+  if(1 == found)
+  {
+    // a cell the recognizer also took for empty stays empty, the others get their digit
+    for(unsigned int k=0; k<count; ++k)
+    {
+      bool empty = false;
+
+      for(unsigned int rank=1; rank<m_Reading->Glyphs(cells[k]); ++rank)
+      {
+        empty = empty || 0 == m_Reading->Glyph(cells[k], rank).m_Value;
+      }
+
+      trial.SetAt(cells[k], empty ? 0 : solution.At(cells[k]));
+    }
+
+    givens = trial;
+    return true;
+  }
+
+  if(2 != found || !Relabel(trial, cells, count, 0, solution))
+  {
+    return false;
+  }
+
+  givens = trial;
+
+  return true;
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::Relabel( CGrid & givens, const unsigned int* cells, unsigned int count, unsigned int index, CGrid & solution )
+{
+  if(index == count)
+  {
+    return 1 == Solutions(givens, &solution);
+  }
+
+  const unsigned int cell = cells[index];
+  const unsigned int read = m_Reading->Glyphs(cell) > 0 ? m_Reading->Glyph(cell, 0).m_Value : 0;
+  unsigned int order[Engine::Size];
+  unsigned int digits = 0;
+
+  // the other guesses of the recognizer first, then the digits it did not offer
+  for(unsigned int rank=1; rank<m_Reading->Glyphs(cell); ++rank)
+  {
+    const unsigned int value = m_Reading->Glyph(cell, rank).m_Value;
+
+    if(0 != value && value != read)
+    {
+      order[digits++] = value;
+    }
+  }
+
+  for(unsigned int value=1; value<=Engine::Size; ++value)
+  {
+    if(value != read && std::find(order, order + digits, value) == order + digits)
+    {
+      order[digits++] = value;
+    }
+  }
+
+  CState state;
+
+  for(unsigned int k=0; k<digits && 0UL != m_Repairs && !isExpired(); ++k)
+  {
+    givens.SetAt(cell, order[k]);
+
+    // a digit the propagation already refutes needs no search
+    if(m_Engine.Load(givens, state) && Relabel(givens, cells, count, index + 1, solution))
+    {
+      return true;
+    }
+  }
+
+  givens.SetAt(cell, 0);
+
+  return false;
+}
+
+template <unsigned int Order>
+unsigned int CReadingSearch<Order>::Solutions( const CGrid & givens, CGrid* solution )
+{
+  CState state;
+
+  // as if the budget ran out
+  if(isExpired())
+  {
+    return 3;
+  }
+
+  if(!m_Engine.Load(givens, state))
+  {
+    return 0;
+  }
+
+  if(0UL == m_Repairs)
+  {
+    return 3;
+  }
+
+  --m_Repairs;
+  ++m_Tried;
+
+  m_Engine.SetLimits(NULL, Budget);
+
+  const unsigned int found = m_Engine.Count(state, 2);
+  const bool aborted = m_Engine.isAborted();
+
+  m_Engine.SetLimits(NULL, 0UL);
+
+  if(0 != found && NULL != solution)
+  {
+    m_Engine.Store(*solution);
+    solution->SetLayout(givens);
+  }
+
+  return aborted && found < 2 ? 3 : found;
+}
+
+template <unsigned int Order>
+float CReadingSearch<Order>::Cost( unsigned int cell ) const
+{
+  return m_Reading->Glyphs(cell) > 0 ? m_Reading->Glyph(cell, 0).m_Confidence : 1.0f;
+}
+
+template <unsigned int Order>
+void CReadingSearch<Order>::Enqueue( std::vector<CRepair> & queue, const CRepair & repair )
+{
+  size_t pos = queue.size();
+
+  while(pos > 0 && queue[pos - 1].m_Cost > repair.m_Cost)
+  {
+    --pos;
+  }
+
+  queue.insert(queue.begin() + pos, repair);
+}
+
+template <unsigned int Order>
+bool CReadingSearch<Order>::isExpired()
+{
+  m_Stopped = m_Stopped ||
+              (NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+              (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline);
+
+  return m_Stopped;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CReadingSolver_h__
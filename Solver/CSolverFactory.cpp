@@ -0,0 +1,142 @@
+#include "stdafx.h"
+#include "CSolverFactory.h"
+#include "CBitboardSolver.h"
+#include "CDlxSolver.h"
+#include "CParallelSolver.h"
+#include "CUniquenessVerifier.h"
+#include "CGrader.h"
+#include "CPuzzleCache.h"
+#include "CPuzzleStore.h"
+#include "CIncrementalSolver.h"
+#include <stdexcept>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CSolverFactory.cpp
+  \brief    Creation of the solver backends.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CSolverFactory::CSolverFactory()
+{
+}
+
+CSolverFactory::~CSolverFactory()
+{
+}
+
+const CSolverFactory & CSolverFactory::Instance()
+{
+  static CSolverFactory obj;
+
+  return obj;
+}
+
+ISolver* CSolverFactory::Create( Backend backend ) const
+{
+  switch(backend)
+  {
+  case Bitboard:
+    return new CBitboardSolver();
+
+  case DancingLinks:
+    return new CDlxSolver();
+
+  case Parallel:
+    return new CParallelSolver();
+  }
+
+  throw std::invalid_argument("Unknown solver backend");
+}
+
+void CSolverFactory::Recycle( ISolver* solver ) const
+{
+  if(NULL != solver)
+  {
+    delete solver;
+  }
+}
+
+IVerifier* CSolverFactory::CreateVerifier() const
+{
+  return new CUniquenessVerifier();
+}
+
+void CSolverFactory::Recycle( IVerifier* verifier ) const
+{
+  if(NULL != verifier)
+  {
+    delete verifier;
+  }
+}
+
+IGrader* CSolverFactory::CreateGrader() const
+{
+  return new CGrader();
+}
+
+void CSolverFactory::Recycle( IGrader* grader ) const
+{
+  if(NULL != grader)
+  {
+    delete grader;
+  }
+}
+
+IPuzzleCache* CSolverFactory::CreateCache( const wchar_t* path ) const
+{
+  if(NULL == path)
+  {
+    return new CPuzzleCache();
+  }
+
+  return new CPuzzleStore(path);
+}
+
+void CSolverFactory::Recycle( IPuzzleCache* cache ) const
+{
+  if(NULL != cache)
+  {
+    delete cache;
+  }
+}
+
+IIncrementalSolver* CSolverFactory::CreateIncremental() const
+{
+  return new CIncrementalSolver();
+}
+
+void CSolverFactory::Recycle( IIncrementalSolver* solver ) const
+{
+  if(NULL != solver)
+  {
+    delete solver;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
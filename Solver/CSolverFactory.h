@@ -0,0 +1,89 @@
+#ifndef CSolverFactory_h__
+#define CSolverFactory_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CSolverFactory.h
+  \brief    Creation of the solver backends.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class  CSolverFactory
+  \brief  This class is responsible for creating and releasing the
+          solver backends.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CSolverFactory : public ISolverFactory
+{
+  explicit CSolverFactory();
+  explicit CSolverFactory(const CSolverFactory &); // not impl.
+  ~CSolverFactory();
+
+public:
+  //! creates a solver using the given backend
+  virtual ISolver*  Create(Backend backend) const;
+
+  //! releases a solver created by this factory
+  virtual void      Recycle(ISolver* solver) const;
+
+  //! creates a uniqueness verifier
+  virtual IVerifier* CreateVerifier() const;
+
+  //! releases a verifier created by this factory
+  virtual void      Recycle(IVerifier* verifier) const;
+
+  //! creates a difficulty grader
+  virtual IGrader*  CreateGrader() const;
+
+  //! releases a grader created by this factory
+  virtual void      Recycle(IGrader* grader) const;
+
+  //! creates a cache of solved puzzles kept in the given database file, NULL for memory only
+  virtual IPuzzleCache* CreateCache(const wchar_t* path) const;
+
+  //! releases a cache created by this factory
+  virtual void      Recycle(IPuzzleCache* cache) const;
+
+  //! creates a solver taking the givens one at a time
+  virtual IIncrementalSolver* CreateIncremental() const;
+
+  //! releases an incremental solver created by this factory
+  virtual void      Recycle(IIncrementalSolver* solver) const;
+
+  //! singleton
+  static const CSolverFactory & Instance();
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CSolverFactory_h__
@@ -0,0 +1,134 @@
+#include "stdafx.h"
+#include "CStatsWriter.h"
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CStatsWriter.cpp
+  \brief    Writes the counters of a solve as JSON.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! the JSON keys of Sudoku::Technique, in the same order
+const char* const TechniqueNames[CSolveStats::Techniques] =
+{
+  "singles",
+  "pointing_pair",
+  "box_line_reduction",
+  "naked_pair",
+  "hidden_pair",
+  "naked_triple",
+  "hidden_triple",
+  "x_wing"
+};
+
+//! writes a string as JSON string, everything beyond ASCII becomes '?'
+void WriteString( const wchar_t* str, std::ostream & output )
+{
+  output << '"';
+
+  for(; NULL != str && 0 != *str; ++str)
+  {
+    const wchar_t c = *str;
+
+    if(L'"' == c || L'\\' == c)
+    {
+      output << '\\' << static_cast<char>(c);
+    }
+    else if(c < 0x20 || c > 0x7e)
+    {
+      output << '?';
+    }
+    else
+    {
+      output << static_cast<char>(c);
+    }
+  }
+
+  output << '"';
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+void CStatsWriter::Write( const CSolveStats & stats, std::ostream & output )
+{
+  const std::ios::fmtflags flags = output.flags();
+  const std::streamsize precision = output.precision();
+
+  output << std::fixed << std::setprecision(1);
+  output << "{\"backend\":";
+  WriteString(stats.m_Backend, output);
+  output << ",\"threads\":" << stats.m_Threads
+         << ",\"micros\":" << stats.m_Micros
+         << ",\"search_micros\":" << stats.m_SearchMicros
+         << ",\"nodes\":" << stats.m_Nodes
+         << ",\"propagations\":" << stats.m_Propagations
+         << ",\"backtracks\":" << stats.m_Backtracks
+         << ",\"max_depth\":" << stats.m_MaxDepth
+         << ",\"techniques\":{";
+
+  for(unsigned int i=0; i<CSolveStats::Techniques; ++i)
+  {
+    output << (0 != i ? "," : "") << '"' << TechniqueNames[i] << "\":{\"steps\":" << stats.m_Steps[i]
+           << ",\"micros\":" << stats.m_TechniqueMicros[i] << '}';
+  }
+
+  output << "}}\n";
+
+  output.flags(flags);
+  output.precision(precision);
+}
+
+bool CStatsWriter::Save( const CSolveStats & stats, const wchar_t* path )
+{
+  std::ofstream file(path);
+
+  if(!file)
+  {
+    return false;
+  }
+
+  Write(stats, file);
+  file.close();
+
+  return !file.fail();
+}
+
+const char* CStatsWriter::TechniqueName( unsigned int technique )
+{
+  return technique < CSolveStats::Techniques ? TechniqueNames[technique] : "";
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
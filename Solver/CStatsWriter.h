@@ -0,0 +1,68 @@
+#ifndef CStatsWriter_h__
+#define CStatsWriter_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CStatsWriter.h
+  \brief    Writes the counters of a solve as JSON.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <iosfwd>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CStatsWriter
+  \brief    Writes a CSolveStats as one JSON object on one line.
+
+  The techniques are keyed by name, each with the progress it made and
+  the time it took. Singles are only timed where the ladder runs, the
+  singles of the search count into its own time.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CStatsWriter
+{
+public:
+  //! writes the stats as one line of JSON
+  static void Write(const CSolveStats & stats, std::ostream & output);
+
+  //! writes the stats into a file of their own, false if it could not be written
+  static bool Save(const CSolveStats & stats, const wchar_t* path);
+
+  //! the JSON key of a technique
+  static const char* TechniqueName(unsigned int technique);
+
+private:
+  CStatsWriter(); // not impl.
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CStatsWriter_h__
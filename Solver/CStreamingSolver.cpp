@@ -0,0 +1,137 @@
+#include "stdafx.h"
+#include "CStreamingSolver.h"
+#include "CSolverFactory.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CStreamingSolver.cpp
+  \brief    Recognizes and propagates a scan while it is received.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CStreamingSolver::CStreamingSolver()
+  : m_Recognizer(NULL),
+    m_Solver(CSolverFactory::Instance().CreateIncremental()),
+    m_Givens(),
+    m_Found(false),
+    m_Rows(0UL)
+{
+}
+
+CStreamingSolver::~CStreamingSolver()
+{
+  CSolverFactory::Instance().Recycle(m_Solver);
+}
+
+void CStreamingSolver::Start( const IGridRecognizer* recognizer )
+{
+  m_Recognizer = recognizer;
+  m_Givens = CGrid();
+  m_Found = false;
+  m_Rows = 0UL;
+}
+
+void CStreamingSolver::OnImageEvent( const IImage & img ) const
+{
+  unsigned long top = 0;
+  unsigned long bottom = 0;
+
+  img.GetReceivedRows(&top, &bottom);
+
+  // a cell spans at least GetHeight() / MaxSize scanlines, smaller steps
+  // can hardly complete one
+  const unsigned long step = img.GetHeight() / (2 * CGrid::MaxSize);
+
+  if(bottom - top < m_Rows + step || bottom == top)
+  {
+    return;
+  }
+
+  m_Rows = bottom - top;
+
+  Read(img, top, bottom);
+}
+
+bool CStreamingSolver::Finish( const IImage & img, CGrid & givens )
+{
+  if(!Read(img, 0, img.GetHeight()))
+  {
+    return false;
+  }
+
+  givens = m_Givens;
+
+  return true;
+}
+
+bool CStreamingSolver::isContradictory() const
+{
+  return m_Solver->isContradictory();
+}
+
+const CGrid & CStreamingSolver::Forced() const
+{
+  return m_Solver->Forced();
+}
+
+bool CStreamingSolver::Read( const IImage & img, unsigned long top, unsigned long bottom ) const
+{
+  CGrid grid;
+
+  if(NULL == m_Recognizer || !m_Recognizer->RecognizeRows(img, top, bottom, grid))
+  {
+    return false;
+  }
+
+  if(!m_Found || grid.Order() != m_Givens.Order())
+  {
+    m_Givens = CGrid(grid.Order());
+    m_Found = m_Solver->Reset(grid.Order());
+
+    if(!m_Found)
+    {
+      return false;
+    }
+  }
+
+  for(unsigned int i=0; i<grid.Cells(); ++i)
+  {
+    const unsigned int value = grid.At(i);
+
+    if(0 != value && 0 == m_Givens.At(i))
+    {
+      m_Givens.SetAt(i, value);
+      m_Solver->Assign(i, value);
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,91 @@
+#ifndef CStreamingSolver_h__
+#define CStreamingSolver_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CStreamingSolver.h
+  \brief    Recognizes and propagates a scan while it is received.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "SolverAPI.h"
+#include "ScannerAPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CStreamingSolver
+  \brief    Reads the givens of a scan band by band while it is streamed.
+
+  Subscribed to an image that is being downloaded, it hands every newly
+  completed range of scanlines to the recognizer and the givens found
+  there to an incremental solver. Once the last chunk has arrived only
+  the cells of the last band are left to read, and the grid handed on to
+  the verifier and the solver is mostly filled by singles already.
+
+  Images notify their observers through a const interface, hence the
+  state of the current scan is mutable.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CStreamingSolver : public IImageObserver
+{
+public:
+  CStreamingSolver();
+  CStreamingSolver(const CStreamingSolver &); // not impl.
+  virtual ~CStreamingSolver();
+
+  //! starts reading a new scan with the given recognizer
+  void Start(const IGridRecognizer* recognizer);
+
+  //! reads the scanlines completed by the last chunk of the image
+  virtual void OnImageEvent(const IImage & img) const;
+
+  //! reads what is left of the complete image, returns false if no grid was found
+  bool Finish(const IImage & img, CGrid & givens);
+
+  //! true if the givens read so far have no solution
+  bool isContradictory() const;
+
+  //! the givens read so far along with every cell they force
+  const CGrid & Forced() const;
+
+private:
+  //! recognizes the scanlines and assigns the givens not seen before
+  bool Read(const IImage & img, unsigned long top, unsigned long bottom) const;
+
+  const IGridRecognizer*  m_Recognizer;
+  IIncrementalSolver*     m_Solver;
+  mutable CGrid           m_Givens;
+  mutable bool            m_Found;
+  mutable unsigned long   m_Rows;       // scanlines read so far
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CStreamingSolver_h__
@@ -0,0 +1,230 @@
+#include "stdafx.h"
+#include "CTreeEstimator.h"
+#include <algorithm>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CTreeEstimator.cpp
+  \brief    Predicts the size of the search tree of a grid by random probes.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+//! the same paths for the same grid, so a grid always gets the same estimate
+const unsigned int Seed = 5489U;
+
+//! random paths per grid by default
+const unsigned int DefaultProbes = 16;
+
+//! estimated milliseconds from which the parallel backend pays off
+const double ParallelMillis = 20.0;
+
+//! the deadline is this many times the estimate, which is often far too low
+const double DeadlineMargin = 10.0;
+
+//! a deadline below this would cut off grids the estimate misjudged
+const unsigned long MinDeadline = 1000UL;
+
+//! a grid estimated to take this many times the limit is not worth starting
+const double RunawayFactor = 10.0;
+
+//! the time the bitboard backend takes to load and propagate the givens
+double MicrosToLoad( unsigned int order )
+{
+  switch(order)
+  {
+  case 3:   return 25.0;
+  case 4:   return 170.0;
+  case 5:   return 700.0;
+  default:  return 5000.0;
+  }
+}
+
+//! the time per search node of the bitboard backend, measured on hard grids
+double MicrosPerNode( unsigned int order )
+{
+  switch(order)
+  {
+  case 3:   return 2.0;
+  case 4:   return 8.0;
+  case 5:   return 100.0;
+  default:  return 200.0;
+  }
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+CTreeEstimator::CTreeEstimator()
+  : m_Engine9(),
+    m_Engine16(),
+    m_Engine25(),
+    m_Engine36(),
+    m_Probes(DefaultProbes),
+    m_Order(0),
+    m_Nodes(0.0),
+    m_Stop(NULL),
+    m_Deadline(std::chrono::steady_clock::time_point::max()),
+    m_Stopped(false)
+{
+  // the same propagation as CBitboardSolver, or the tree would be another one
+  m_Engine25.UseMatching(true);
+  m_Engine36.UseMatching(true);
+}
+
+CTreeEstimator::~CTreeEstimator()
+{
+}
+
+bool CTreeEstimator::Estimate( const CGrid & grid )
+{
+  m_Order = grid.Order();
+  m_Nodes = 0.0;
+  m_Stopped = false;
+
+  switch(m_Order)
+  {
+  case 3:   return Estimate(m_Engine9, grid);
+  case 4:   return Estimate(m_Engine16, grid);
+  case 5:   return Estimate(m_Engine25, grid);
+  case 6:   return Estimate(m_Engine36, grid);
+  default:  return false;
+  }
+}
+
+void CTreeEstimator::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Stop = stop;
+  m_Deadline = deadline;
+}
+
+double CTreeEstimator::Millis() const
+{
+  return (MicrosToLoad(m_Order) + m_Nodes * MicrosPerNode(m_Order)) * 1e-3;
+}
+
+ISolverFactory::Backend CTreeEstimator::Backend() const
+{
+  // starting the threads costs more than a small tree takes
+  return Millis() >= ParallelMillis ? ISolverFactory::Parallel : ISolverFactory::Bitboard;
+}
+
+unsigned long CTreeEstimator::Deadline( unsigned long limit ) const
+{
+  const double millis = DeadlineMargin * Millis();
+
+  if(millis >= limit)
+  {
+    return limit;
+  }
+
+  return millis > MinDeadline ? static_cast<unsigned long>(millis) : std::min(MinDeadline, limit);
+}
+
+bool CTreeEstimator::isRunaway( unsigned long limit ) const
+{
+  return Millis() > RunawayFactor * limit;
+}
+
+template <unsigned int Order>
+bool CTreeEstimator::Estimate( CBitboardEngine<Order> & engine, const CGrid & grid )
+{
+  typedef CBitboardEngine<Order> Engine;
+
+  typename Engine::CState root;
+  typename Engine::CState probe;
+
+  if(!engine.Load(grid, root))
+  {
+    return false;
+  }
+
+  std::mt19937 rng(Seed);
+  double sum = 0.0;
+
+  for(unsigned int i=0; i<m_Probes && !isExpired(); ++i)
+  {
+    double width = 1.0;   // the nodes of the level, as far as this path tells
+    double nodes = 1.0;   // the root
+
+    probe = root;
+
+    for(unsigned int cell=Engine::SelectCell(probe); Engine::Cells != cell; cell=Engine::SelectCell(probe))
+    {
+      typename Engine::Mask candidates = probe.m_Candidates[cell];
+      const unsigned int count = PopCount(candidates);
+
+      if(0 == count)
+      {
+        break;
+      }
+
+      // the digit taken is the one left after dropping a random number of the lowest
+      for(unsigned int skip=rng() % count; 0 != skip; --skip)
+      {
+        candidates &= candidates - 1;
+      }
+
+      width *= count;
+
+      // a rejected digit has no subtree, the search does not count it as a node either
+      if(!engine.Assign(probe, cell, LowestBit(candidates) + 1) || isExpired())
+      {
+        break;
+      }
+
+      nodes += width;
+    }
+
+    sum += nodes;
+  }
+
+  if(m_Stopped)
+  {
+    return false;
+  }
+
+  m_Nodes = sum / m_Probes;
+
+  return true;
+}
+
+bool CTreeEstimator::isExpired()
+{
+  m_Stopped = m_Stopped ||
+              (NULL != m_Stop && m_Stop->load(std::memory_order_relaxed)) ||
+              (std::chrono::steady_clock::time_point::max() != m_Deadline && std::chrono::steady_clock::now() >= m_Deadline);
+
+  return m_Stopped;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
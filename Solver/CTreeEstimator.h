@@ -0,0 +1,121 @@
+#ifndef CTreeEstimator_h__
+#define CTreeEstimator_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CTreeEstimator.h
+  \brief    Predicts the size of the search tree of a grid by random probes.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "SolverAPI.h"
+#include "CBitboardSolver.h"
+#include <atomic>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CTreeEstimator
+  \brief    Predicts how long the bitboard search of a grid will take.
+
+  Knuth's estimator: each probe propagates the givens like the bitboard
+  engine does and walks down a single random path of the search tree,
+  branching on the same cell the search would. A level with d candidates
+  is taken to have d times as many nodes as the level above, a digit the
+  propagation rejects ends the probe. The mean over all probes is an
+  unbiased estimate of the nodes of the full tree, with a heavy tail, so
+  the figures are meant for scheduling, not for reporting.
+
+  From the nodes and the measured time per node of each order it tells
+  whether the parallel backend is worth starting, what deadline to give
+  the solve, and whether the grid would run far past any sensible limit,
+  which for a scanned grid almost always means a misread digit.
+
+  Probing a sparse 25x25 or 36x36 grid takes up to a few seconds, so the
+  estimate belongs on the solving thread, with the limits of the solve.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CTreeEstimator
+{
+public:
+  CTreeEstimator();
+  CTreeEstimator(const CTreeEstimator &); // not impl.
+  ~CTreeEstimator();
+
+  //! probes the search tree of the grid, false if its order is not supported, propagation finds no solution or the limits stopped it
+  bool Estimate(const CGrid & grid);
+
+  //! stops Estimate() once the flag is set or the deadline has passed, both looked at every step of a probe
+  void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! true if the last call to Estimate() was stopped by SetLimits()
+  bool isStopped() const { return m_Stopped; }
+
+  //! the estimated search nodes of the last grid, 1 if propagation alone fills it
+  double Nodes() const { return m_Nodes; }
+
+  //! the estimated time in milliseconds the bitboard backend takes for the last grid
+  double Millis() const;
+
+  //! the backend to solve the last grid with
+  ISolverFactory::Backend Backend() const;
+
+  //! the milliseconds to give the last grid, a multiple of the estimate but at most the limit
+  unsigned long Deadline(unsigned long limit) const;
+
+  //! true if the last grid is estimated to take many times the limit in milliseconds
+  bool isRunaway(unsigned long limit) const;
+
+  //! the number of random paths per grid, more give a steadier estimate
+  void SetProbes(unsigned int probes) { m_Probes = 0 != probes ? probes : 1; }
+
+private:
+  //! probes the grid with the engine of its order
+  template <unsigned int Order>
+  bool Estimate(CBitboardEngine<Order> & engine, const CGrid & grid);
+
+  //! true once the stop flag is set or the deadline has passed
+  bool isExpired();
+
+  CBitboardEngine<3>  m_Engine9;
+  CBitboardEngine<4>  m_Engine16;
+  CBitboardEngine<5>  m_Engine25;
+  CBitboardEngine<6>  m_Engine36;
+  unsigned int        m_Probes;
+  unsigned int        m_Order;    // of the last grid
+  double              m_Nodes;    // estimated for the last grid
+  const std::atomic<bool>*              m_Stop;
+  std::chrono::steady_clock::time_point m_Deadline;
+  bool                                  m_Stopped;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CTreeEstimator_h__
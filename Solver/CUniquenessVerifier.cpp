@@ -0,0 +1,89 @@
+#include "stdafx.h"
+#include "CUniquenessVerifier.h"
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CUniquenessVerifier.cpp
+  \brief    Counts the solutions of a grid to tell unique from ambiguous givens.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+
+CUniquenessVerifier::CUniquenessVerifier( unsigned int threads )
+  : m_Solver(threads),
+    m_Solution()
+{
+}
+
+CUniquenessVerifier::~CUniquenessVerifier()
+{
+}
+
+IVerifier::Verdict CUniquenessVerifier::Verify( const CGrid & grid )
+{
+  m_Solution = CGrid(grid.Order());
+  m_Solution.SetLayout(grid);
+
+  // a second solution is all it takes to reject the givens
+  const unsigned int found = m_Solver.Count(grid, 2, m_Solution);
+
+  if(found < 2 && m_Solver.isStopped())
+  {
+    // a solution not proven unique is still the fullest state reached
+    if(0 == found)
+    {
+      m_Solver.Partial(m_Solution);
+    }
+
+    return Undecided;
+  }
+
+  switch(found)
+  {
+  case 0:   return Contradictory;
+  case 1:   return Unique;
+  default:  return Ambiguous;
+  }
+}
+
+void CUniquenessVerifier::SetLimits( const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline )
+{
+  m_Solver.SetLimits(stop, deadline);
+}
+
+const CGrid & CUniquenessVerifier::Solution() const
+{
+  return m_Solution;
+}
+
+unsigned long CUniquenessVerifier::Nodes() const
+{
+  return m_Solver.Nodes();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
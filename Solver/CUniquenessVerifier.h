@@ -0,0 +1,77 @@
+#ifndef CUniquenessVerifier_h__
+#define CUniquenessVerifier_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     CUniquenessVerifier.h
+  \brief    Counts the solutions of a grid to tell unique from ambiguous givens.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include "CParallelSolver.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CUniquenessVerifier
+  \brief    Tells whether OCR'd givens have none, one or several solutions.
+
+  The parallel search counts the solutions and stops at the second one,
+  all workers share one counter and one cancel flag. An ambiguous or
+  contradictory verdict means a cell was most likely misread.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CUniquenessVerifier : public IVerifier
+{
+public:
+  //! uses one worker per hardware thread if no count is given
+  explicit CUniquenessVerifier(unsigned int threads = 0);
+  CUniquenessVerifier(const CUniquenessVerifier &); // not impl.
+  virtual ~CUniquenessVerifier();
+
+  //! counts the solutions of the grid, stopping at the second one
+  virtual Verdict Verify(const CGrid & grid);
+
+  //! stops Verify() once the flag is set or the deadline has passed
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline);
+
+  //! the first solution found by the last call to Verify()
+  virtual const CGrid & Solution() const;
+
+  //! the number of search nodes visited by the last call to Verify()
+  unsigned long Nodes() const;
+
+private:
+  CParallelSolver m_Solver;
+  CGrid           m_Solution;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // CUniquenessVerifier_h__
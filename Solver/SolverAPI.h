@@ -0,0 +1,684 @@
+#ifndef SolverAPI_h__
+#define SolverAPI_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     SolverAPI.h
+  \brief    Simple API interface definitions for solving Sudokus.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+
+class IImage;
+class ISolver;
+class IVerifier;
+class IGrader;
+class IPuzzleCache;
+class IIncrementalSolver;
+class ISolverFactory;
+class IGridRecognizer;
+class ISolveObserver;
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class  CGrid
+  \brief  Plain value type holding the cells of a Sudoku.
+
+  The grid is made of Order x Order boxes, each with Order x Order cells,
+  so a classic Sudoku has the order 3 and a Hexadoku the order 4.
+  A cell holds 0 if it is empty, otherwise a value from 1 to Size().
+
+  Variants replace the boxes by irregular regions of Size() cells each
+  (jigsaw) or add both main diagonals as units, the layout is kept apart
+  from the cells, so Clear() leaves it as it is.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CGrid
+{
+public:
+  enum
+  {
+    MinOrder = 3,
+    MaxOrder = 6,
+    MaxSize  = MaxOrder * MaxOrder,
+    MaxCells = MaxSize * MaxSize
+  };
+
+  //! construction of an empty grid with the plain box layout
+  explicit CGrid(unsigned int order = 4)
+    : m_Order(order),
+      m_Jigsaw(false),
+      m_Diagonals(false)
+  {
+    Clear();
+  }
+
+  //! the box order of this grid
+  unsigned int Order() const { return m_Order; }
+
+  //! the number of cells per row, column and box
+  unsigned int Size() const { return m_Order * m_Order; }
+
+  //! the total number of cells
+  unsigned int Cells() const { return Size() * Size(); }
+
+  //! gets the value of the cell with the given index
+  unsigned int At(unsigned int idx) const { return m_Cells[idx]; }
+
+  //! sets the value of the cell with the given index
+  void SetAt(unsigned int idx, unsigned int value) { m_Cells[idx] = static_cast<unsigned char>(value); }
+
+  //! gets the value of a cell
+  unsigned int Get(unsigned int row, unsigned int col) const { return m_Cells[row * Size() + col]; }
+
+  //! sets the value of a cell
+  void Set(unsigned int row, unsigned int col, unsigned int value) { SetAt(row * Size() + col, value); }
+
+  //! empties all cells
+  void Clear() { memset(m_Cells, 0, sizeof(m_Cells)); }
+
+  //! the region (0-based) of the cell with the given index, its box unless regions were set
+  unsigned int Region(unsigned int idx) const
+  {
+    if(m_Jigsaw)
+    {
+      return m_Regions[idx];
+    }
+
+    const unsigned int row = idx / Size();
+    const unsigned int col = idx % Size();
+
+    return (row / m_Order) * m_Order + col / m_Order;
+  }
+
+  //! gives each cell the region (0-based) of the array, each region must hold Size() cells
+  void SetRegions(const unsigned char* regions)
+  {
+    m_Jigsaw = false;
+
+    for(unsigned int i=0; i<Cells(); ++i)
+    {
+      if(regions[i] != Region(i))
+      {
+        memcpy(m_Regions, regions, Cells());
+        m_Jigsaw = true;
+        break;
+      }
+    }
+  }
+
+  //! true if both main diagonals are units as well
+  bool hasDiagonals() const { return m_Diagonals; }
+
+  //! makes both main diagonals units as well
+  void SetDiagonals(bool diagonals) { m_Diagonals = diagonals; }
+
+  //! true for the plain box layout without diagonals
+  bool isStandard() const { return !m_Jigsaw && !m_Diagonals; }
+
+  //! true if the other grid has the same regions and diagonals
+  bool hasSameLayout(const CGrid & other) const
+  {
+    return m_Order == other.m_Order && m_Jigsaw == other.m_Jigsaw && m_Diagonals == other.m_Diagonals &&
+           (!m_Jigsaw || 0 == memcmp(m_Regions, other.m_Regions, Cells()));
+  }
+
+  //! takes the regions and diagonals of another grid of the same order
+  void SetLayout(const CGrid & other)
+  {
+    m_Jigsaw = other.m_Jigsaw;
+    m_Diagonals = other.m_Diagonals;
+    memcpy(m_Regions, other.m_Regions, sizeof(m_Regions));
+  }
+
+  //! the number of filled cells
+  unsigned int CountGivens() const
+  {
+    unsigned int count = 0;
+
+    for(unsigned int i=0; i<Cells(); ++i)
+    {
+      if(0 != m_Cells[i])
+      {
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+  //! the printed symbol of a value, '.' for empty cells
+  wchar_t Symbol(unsigned int value) const
+  {
+    if(0 == value || value > Size())
+    {
+      return L'.';
+    }
+
+    switch(m_Order)
+    {
+    case 3:   return static_cast<wchar_t>(L'0' + value);               // 1..9
+    case 4:   return L"0123456789ABCDEF"[value - 1];                   // Hexadoku
+    case 5:   return static_cast<wchar_t>(L'A' + value - 1);           // letters
+    default:  return L"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[value - 1]; // digits, then letters
+    }
+  }
+
+  //! the value of a printed symbol, 0 for '.' and anything else unknown
+  unsigned int Value(wchar_t symbol) const
+  {
+    if(symbol >= L'a' && symbol <= L'z')
+    {
+      symbol = static_cast<wchar_t>(symbol - L'a' + L'A');
+    }
+
+    for(unsigned int value=1; value<=Size(); ++value)
+    {
+      if(Symbol(value) == symbol)
+      {
+        return value;
+      }
+    }
+
+    return 0;
+  }
+
+private:
+  unsigned int  m_Order;
+  unsigned char m_Cells[MaxCells];
+  unsigned char m_Regions[MaxCells];  // only used for irregular regions
+  bool          m_Jigsaw;
+  bool          m_Diagonals;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class  CReading
+  \brief  Plain value type holding what the recognizer read in each cell.
+
+  Instead of one hard digit a cell keeps up to MaxGlyphs guesses ranked
+  by their confidence from 0 to 1, the most likely first. A guess of 0
+  means the cell looked empty, a cell without any guess is taken as
+  empty.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CReading
+{
+public:
+  enum
+  {
+    MaxGlyphs = 4
+  };
+
+  //! one guess of the recognizer
+  struct CGlyph
+  {
+    unsigned char m_Value;        // 0 = empty, else 1 to Size()
+    float         m_Confidence;   // 0 to 1
+  };
+
+  //! construction of a reading without any guesses
+  explicit CReading(unsigned int order = 4)
+    : m_Order(order)
+  {
+    Clear();
+  }
+
+  //! the box order of the grid read
+  unsigned int Order() const { return m_Order; }
+
+  //! the total number of cells
+  unsigned int Cells() const { return m_Order * m_Order * m_Order * m_Order; }
+
+  //! forgets all guesses
+  void Clear() { memset(m_Counts, 0, sizeof(m_Counts)); }
+
+  //! the number of guesses for the cell with the given index
+  unsigned int Glyphs(unsigned int idx) const { return m_Counts[idx]; }
+
+  //! a guess for a cell, rank 0 is the most likely one
+  const CGlyph & Glyph(unsigned int idx, unsigned int rank) const { return m_Glyphs[idx][rank]; }
+
+  //! adds a guess for a cell, the least likely one drops out once MaxGlyphs are kept
+  void Add(unsigned int idx, unsigned int value, float confidence)
+  {
+    CGlyph* const glyphs = m_Glyphs[idx];
+    unsigned int count = m_Counts[idx];
+    unsigned int pos = 0;
+
+    // a value read twice keeps its better confidence
+    while(pos < count && glyphs[pos].m_Value != value)
+    {
+      ++pos;
+    }
+
+    if(pos < count)
+    {
+      if(glyphs[pos].m_Confidence >= confidence)
+      {
+        return;
+      }
+    }
+    else if(count < MaxGlyphs)
+    {
+      pos = count++;
+    }
+    else if(glyphs[MaxGlyphs - 1].m_Confidence < confidence)
+    {
+      pos = MaxGlyphs - 1;
+    }
+    else
+    {
+      return;
+    }
+
+    for(; pos > 0 && glyphs[pos - 1].m_Confidence < confidence; --pos)
+    {
+      glyphs[pos] = glyphs[pos - 1];
+    }
+
+    glyphs[pos].m_Value = static_cast<unsigned char>(value);
+    glyphs[pos].m_Confidence = confidence;
+    m_Counts[idx] = static_cast<unsigned char>(count);
+  }
+
+  //! writes the most likely value of each cell into a grid of the same order
+  void Best(CGrid & grid) const
+  {
+    grid.Clear();
+
+    for(unsigned int i=0; i<Cells(); ++i)
+    {
+      if(0 != m_Counts[i])
+      {
+        grid.SetAt(i, m_Glyphs[i][0].m_Value);
+      }
+    }
+  }
+
+private:
+  unsigned int  m_Order;
+  unsigned char m_Counts[CGrid::MaxCells];
+  CGlyph        m_Glyphs[CGrid::MaxCells][MaxGlyphs];
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class  CSolveStats
+  \brief  Plain value type holding what a solver did for the last grid.
+
+  Every thread of a solver counts into its own stats, they are merged
+  once the grid is done. The technique slots follow Sudoku::Technique,
+  singles first.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CSolveStats
+{
+public:
+  enum
+  {
+    Techniques = 8
+  };
+
+  CSolveStats() { Clear(); }
+
+  //! forgets all figures
+  void Clear()
+  {
+    m_Backend = L"";
+    m_Nodes = 0UL;
+    m_Propagations = 0UL;
+    m_Backtracks = 0UL;
+    m_MaxDepth = 0;
+    m_Threads = 1;
+    m_Micros = 0.0;
+    m_SearchMicros = 0.0;
+
+    for(unsigned int i=0; i<Techniques; ++i)
+    {
+      m_Steps[i] = 0UL;
+      m_TechniqueMicros[i] = 0.0;
+    }
+  }
+
+  //! adds the counters of another thread, the times add up to CPU time
+  void Merge(const CSolveStats & other)
+  {
+    m_Nodes += other.m_Nodes;
+    m_Propagations += other.m_Propagations;
+    m_Backtracks += other.m_Backtracks;
+    m_SearchMicros += other.m_SearchMicros;
+
+    if(other.m_MaxDepth > m_MaxDepth)
+    {
+      m_MaxDepth = other.m_MaxDepth;
+    }
+
+    for(unsigned int i=0; i<Techniques; ++i)
+    {
+      m_Steps[i] += other.m_Steps[i];
+      m_TechniqueMicros[i] += other.m_TechniqueMicros[i];
+    }
+  }
+
+  const wchar_t*  m_Backend;        // the backend that found the answer
+  unsigned long   m_Nodes;          // search nodes visited
+  unsigned long   m_Propagations;   // propagation passes run
+  unsigned long   m_Backtracks;     // branches taken back
+  unsigned int    m_MaxDepth;       // deepest search level reached
+  unsigned int    m_Threads;        // threads that took part
+  double          m_Micros;         // wall-clock time of the whole solve
+  double          m_SearchMicros;   // time spent below the root
+  unsigned long   m_Steps[Techniques];            // progress made per technique
+  double          m_TechniqueMicros[Techniques];  // time spent per technique
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  ISolver
+  \brief      Implementers of this interface are able to solve Sudokus.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class ISolver
+{
+public:
+  virtual ~ISolver() {}
+
+  //! the name of the solver backend
+  virtual const wchar_t* GetName() const = 0;
+
+  //! true if the solver handles grids of the given box order
+  virtual bool Supports(unsigned int order) const = 0;
+
+  //! fills the empty cells of the grid, returns false if there is no solution
+  virtual bool Solve(CGrid & grid) = 0;
+
+  //! what the last call to Solve() did
+  virtual const CSolveStats & Stats() const = 0;
+
+  //! stops Solve() once the flag is set or the deadline has passed, NULL and time_point::max() for none
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline) = 0;
+
+  //! true if the last call to Solve() was stopped by the limits before it could tell
+  virtual bool isStopped() const = 0;
+
+  //! writes the fullest consistent state the last call to Solve() reached into the grid
+  virtual void Partial(CGrid & grid) const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  IVerifier
+  \brief      Implementers of this interface are able to tell whether the
+              givens of a Sudoku have exactly one solution.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class IVerifier
+{
+public:
+  //! the outcome of a verification
+  enum Verdict
+  {
+    Contradictory,  //!< no solution at all
+    Unique,         //!< exactly one solution
+    Ambiguous,      //!< more than one solution
+    Undecided       //!< stopped by the limits before it could tell
+  };
+
+  virtual ~IVerifier() {}
+
+  //! counts the solutions of the grid, stopping at the second one
+  virtual Verdict Verify(const CGrid & grid) = 0;
+
+  //! stops Verify() once the flag is set or the deadline has passed, NULL and time_point::max() for none
+  virtual void SetLimits(const std::atomic<bool>* stop, std::chrono::steady_clock::time_point deadline) = 0;
+
+  //! the first solution found by the last call to Verify(), the fullest state reached if Undecided
+  virtual const CGrid & Solution() const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  IGrader
+  \brief      Implementers of this interface are able to rate how hard a
+              Sudoku is for a human solver.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class IGrader
+{
+public:
+  //! the difficulty of a Sudoku
+  enum Grade
+  {
+    Easy,           //!< singles only
+    Medium,         //!< pointing pairs and box-line reductions
+    Hard,           //!< naked and hidden pairs
+    Expert,         //!< triples and X-Wings
+    Extreme,        //!< needs guessing
+    Unsolvable      //!< the givens contradict each other
+  };
+
+  virtual ~IGrader() {}
+
+  //! rates the grid by the hardest technique needed to solve it
+  virtual Grade Rate(const CGrid & grid) = 0;
+
+  //! the printable name of a grade
+  virtual const wchar_t* GetName(Grade grade) const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  IPuzzleCache
+  \brief      Implementers of this interface remember solved Sudokus and
+              recognize them again, even relabelled or rearranged.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class IPuzzleCache
+{
+public:
+  virtual ~IPuzzleCache() {}
+
+  //! fills the empty cells of the grid if its givens were solved before
+  virtual bool Lookup(CGrid & grid) = 0;
+
+  //! remembers the solution of the givens and the figures of the solve that found it
+  virtual void Insert(const CGrid & givens, const CGrid & solution, const CSolveStats & stats) = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  IIncrementalSolver
+  \brief      Implementers of this interface take the givens of a Sudoku
+              one at a time and propagate each of them right away.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class IIncrementalSolver
+{
+public:
+  virtual ~IIncrementalSolver() {}
+
+  //! starts over with an empty grid of the given box order
+  virtual bool Reset(unsigned int order) = 0;
+
+  //! adds a given, returns false if it contradicts the givens so far
+  virtual bool Assign(unsigned int cell, unsigned int value) = 0;
+
+  //! true if the givens so far have no solution
+  virtual bool isContradictory() const = 0;
+
+  //! the givens so far along with every cell they force
+  virtual const CGrid & Forced() const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class  CSolveResult
+  \brief  Plain value type holding the outcome of a solve in the background.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class CSolveResult
+{
+public:
+  //! how the solve ended
+  enum Status
+  {
+    Solved,         //!< the grid holds the only solution
+    Contradictory,  //!< the givens have no solution
+    Ambiguous,      //!< the givens have more than one solution
+    TimedOut,       //!< the deadline passed, the grid holds the fullest state reached
+    Cancelled,      //!< the token was cancelled, the grid holds the fullest state reached
+    Runaway         //!< estimated to search far past the deadline, the grid was not searched
+  };
+
+  CSolveResult()
+    : m_Status(Cancelled),
+      m_Grid(),
+      m_Givens(),
+      m_Stats()
+  {
+  }
+
+  Status        m_Status;
+  CGrid         m_Grid;
+  CGrid         m_Givens;   // picked among the guesses of a reading, as far as it got; empty for other solves
+  CSolveStats   m_Stats;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  ISolveObserver
+  \brief      Implementers of this interface are told when a solve in the
+              background has ended.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class ISolveObserver
+{
+public:
+  virtual ~ISolveObserver() {}
+
+  //! called on the solving thread, so the observer has to hand the result on to its own thread
+  virtual void OnSolveEvent(const CSolveResult & result) const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  ISolverFactory
+  \brief      Implementers of this interface are able to create the
+              solver backends.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class ISolverFactory
+{
+public:
+  //! the available solver backends
+  enum Backend
+  {
+    Bitboard,       //!< constraint propagation on candidate bitmasks
+    DancingLinks,   //!< exact cover search
+    Parallel        //!< bitboard search split among all cores
+  };
+
+  virtual ~ISolverFactory() {}
+
+  //! creates a solver using the given backend
+  virtual ISolver*  Create(Backend backend) const = 0;
+
+  //! releases a solver created by this factory
+  virtual void      Recycle(ISolver* solver) const = 0;
+
+  //! creates a uniqueness verifier
+  virtual IVerifier* CreateVerifier() const = 0;
+
+  //! releases a verifier created by this factory
+  virtual void      Recycle(IVerifier* verifier) const = 0;
+
+  //! creates a difficulty grader
+  virtual IGrader*  CreateGrader() const = 0;
+
+  //! releases a grader created by this factory
+  virtual void      Recycle(IGrader* grader) const = 0;
+
+  //! creates a cache of solved puzzles kept in the given database file, NULL for memory only
+  virtual IPuzzleCache* CreateCache(const wchar_t* path) const = 0;
+
+  //! releases a cache created by this factory
+  virtual void      Recycle(IPuzzleCache* cache) const = 0;
+
+  //! creates a solver taking the givens one at a time
+  virtual IIncrementalSolver* CreateIncremental() const = 0;
+
+  //! releases an incremental solver created by this factory
+  virtual void      Recycle(IIncrementalSolver* solver) const = 0;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \interface  IGridRecognizer
+  \brief      Implementers of this interface are able to read the given
+              digits of a Sudoku from a scanned image.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+class IGridRecognizer
+{
+public:
+  virtual ~IGridRecognizer() {}
+
+  //! extracts the givens printed on the image, returns false if no grid was found
+  virtual bool Recognize(const IImage & img, CGrid & grid) const = 0;
+
+  //! extracts the givens of the cells lying completely within the scanlines
+  //! from top to bottom of an image still being received, returns false
+  //! while the grid has not been found
+  virtual bool RecognizeRows(const IImage & img, unsigned long top, unsigned long bottom, CGrid & grid) const = 0;
+
+  //! extracts the ranked guesses with their confidences for every cell, returns false if no grid was found
+  virtual bool RecognizeGlyphs(const IImage & img, CReading & reading) const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // SolverAPI_h__
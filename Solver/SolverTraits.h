@@ -0,0 +1,362 @@
+#ifndef SolverTraits_h__
+#define SolverTraits_h__
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \file     SolverTraits.h
+  \brief    Compile-time geometry of the supported grid sizes.
+  \author   Falk Schilling <falk.schilling.de (at) ieee.org >
+  \license  GPLv3
+
+  This file is part of HexasudokuSolver.
+
+  HexasudokuSolver is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  HexasudokuSolver is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with HexasudokuSolver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+#include "SolverAPI.h"
+#include <stdint.h>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Sudoku {
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \struct   CMaskType
+  \brief    Selects the smallest unsigned type holding one bit per digit.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Size, unsigned int Bits = (Size <= 16 ? 16 : Size <= 32 ? 32 : 64)>
+struct CMaskType
+{
+  typedef uint16_t Type;
+};
+
+template <unsigned int Size>
+struct CMaskType<Size, 32>
+{
+  typedef uint32_t Type;
+};
+
+template <unsigned int Size>
+struct CMaskType<Size, 64>
+{
+  typedef uint64_t Type;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \struct   CGridTables
+  \brief    Flat lookup tables of the cells, units and peers of a grid.
+
+  Units are numbered rows first, then columns, then regions, then the two
+  main diagonals if the layout has them. The cells of a unit are listed
+  in reading order, so a cell's position within its row is its column,
+  within its column its row. The peers of a cell are listed as its row,
+  its column and the cells of its other units not seen before.
+
+  The solvers know nothing about boxes, everything they need about the
+  layout is in here, so irregular regions and diagonals cost as much as
+  the plain grid.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+struct CGridTables
+{
+  typedef typename CMaskType<Order * Order>::Type Mask;
+
+  enum
+  {
+    Size      = Order * Order,
+    Cells     = Size * Size,
+    Units     = 3 * Size + 2,
+    CellUnits = 5,                  // a cell on both diagonals
+    Peers     = 5 * (Size - 1),     // at most, units overlap
+    Crossings = 2 * Size            // at most per unit, each one shares two cells or more
+  };
+
+  //! another unit sharing two cells or more with a unit
+  struct CCrossing
+  {
+    unsigned short  m_Unit;
+    Mask            m_Inside;       // positions of the shared cells within the unit
+    Mask            m_Other;        // and within the other unit
+  };
+
+  //! empty tables, Build() fills them
+  CGridTables() : m_UsedUnits(0) {}
+
+  //! the tables of the given layout
+  explicit CGridTables(const CGrid & layout) { Build(layout); }
+
+  //! builds the tables of the regions and diagonals of the grid, false if a region does not hold Size cells
+  bool Build(const CGrid & layout);
+
+  unsigned short  m_Units[Units][Size];         // cells of each unit
+  unsigned short  m_CellUnits[Cells][CellUnits]; // units of each cell
+  unsigned char   m_Positions[Cells][CellUnits]; // position of each cell within these units
+  unsigned char   m_UnitCount[Cells];
+  unsigned short  m_Peers[Cells][Peers];        // cells sharing a unit with each cell
+  unsigned char   m_PeerCount[Cells];
+  CCrossing       m_Crossings[Units][Crossings];
+  unsigned char   m_CrossingCount[Units];
+  unsigned int    m_UsedUnits;                  // 3 * Size without diagonals
+};
+
+template <unsigned int Order>
+bool CGridTables<Order>::Build( const CGrid & layout )
+{
+  if(layout.Order() != Order)
+  {
+    return false;
+  }
+
+  unsigned int filled[Units] = {0};
+
+  m_UsedUnits = layout.hasDiagonals() ? Units : 3 * Size;
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    const unsigned int row = cell / Size;
+    const unsigned int col = cell % Size;
+    const unsigned int region = layout.Region(cell);
+
+    if(region >= Size)
+    {
+      return false;
+    }
+
+    unsigned int units[CellUnits] = { row, Size + col, 2 * Size + region, 0, 0 };
+    unsigned int count = 3;
+
+    if(layout.hasDiagonals() && row == col)
+    {
+      units[count++] = 3 * Size;
+    }
+
+    if(layout.hasDiagonals() && row + col == Size - 1)
+    {
+      units[count++] = 3 * Size + 1;
+    }
+
+    m_UnitCount[cell] = static_cast<unsigned char>(count);
+
+    for(unsigned int k=0; k<count; ++k)
+    {
+      const unsigned int unit = units[k];
+
+      if(filled[unit] >= Size)
+      {
+        return false;   // a region too large
+      }
+
+      m_CellUnits[cell][k] = static_cast<unsigned short>(unit);
+      m_Positions[cell][k] = static_cast<unsigned char>(filled[unit]);
+      m_Units[unit][filled[unit]++] = static_cast<unsigned short>(cell);
+    }
+  }
+
+  // every region got exactly Size cells, as none got more
+  unsigned short seen[Cells];
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    seen[cell] = static_cast<unsigned short>(Cells);
+  }
+
+  for(unsigned int cell=0; cell<Cells; ++cell)
+  {
+    unsigned int count = 0;
+
+    seen[cell] = static_cast<unsigned short>(cell);
+
+    for(unsigned int k=0; k<m_UnitCount[cell]; ++k)
+    {
+      const unsigned short* const cells = m_Units[m_CellUnits[cell][k]];
+
+      for(unsigned int i=0; i<Size; ++i)
+      {
+        if(seen[cells[i]] != cell)
+        {
+          seen[cells[i]] = static_cast<unsigned short>(cell);
+          m_Peers[cell][count++] = cells[i];
+        }
+      }
+    }
+
+    m_PeerCount[cell] = static_cast<unsigned char>(count);
+  }
+
+  // the shared positions of each pair of units
+  for(unsigned int unit=0; unit<m_UsedUnits; ++unit)
+  {
+    Mask inside[Units] = {0};
+    Mask other[Units] = {0};
+    unsigned int count = 0;
+
+    for(unsigned int pos=0; pos<Size; ++pos)
+    {
+      const unsigned int cell = m_Units[unit][pos];
+
+      for(unsigned int k=0; k<m_UnitCount[cell]; ++k)
+      {
+        inside[m_CellUnits[cell][k]] |= static_cast<Mask>(Mask(1) << pos);
+        other[m_CellUnits[cell][k]] |= static_cast<Mask>(Mask(1) << m_Positions[cell][k]);
+      }
+    }
+
+    for(unsigned int crossed=0; crossed<m_UsedUnits; ++crossed)
+    {
+      const Mask shared = inside[crossed];
+
+      // a single shared cell is no more than a hidden single
+      if(crossed != unit && 0 != (shared & (shared - 1)))
+      {
+        m_Crossings[unit][count].m_Unit = static_cast<unsigned short>(crossed);
+        m_Crossings[unit][count].m_Inside = shared;
+        m_Crossings[unit][count++].m_Other = other[crossed];
+      }
+    }
+
+    m_CrossingCount[unit] = static_cast<unsigned char>(count);
+  }
+
+  return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \struct   CGridTraits
+  \brief    Sizes and mask type of a grid with the given box order, all
+            known at compile time, and the tables of its plain layout.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order_>
+struct CGridTraits
+{
+  enum
+  {
+    Order = Order_,
+    Size  = Order * Order,
+    Cells = Size * Size,
+    Units = CGridTables<Order_>::Units,
+    Peers = CGridTables<Order_>::Peers
+  };
+
+  typedef typename CMaskType<Size>::Type Mask;
+  typedef CGridTables<Order_> Tables;
+
+  static constexpr Mask AllDigits = static_cast<Mask>((uint64_t(1) << Size) - 1);
+
+  //! the tables of the plain box layout, built once on first use
+  static const Tables & Standard()
+  {
+    static const Tables tables((CGrid(Order)));
+    return tables;
+  }
+};
+
+template <unsigned int Order_>
+constexpr typename CGridTraits<Order_>::Mask CGridTraits<Order_>::AllDigits;
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+  \class    CLayoutTables
+  \brief    Selects the tables of the layout of a grid for an engine.
+
+  The plain layout uses the shared tables of CGridTraits, any other one
+  gets tables of its own, which are only built again when the layout
+  changes.
+*/
+//////////////////////////////////////////////////////////////////////////
+
+template <unsigned int Order>
+class CLayoutTables
+{
+public:
+  typedef CGridTables<Order> Tables;
+
+  CLayoutTables()
+    : m_Tables(&CGridTraits<Order>::Standard()),
+      m_Variant(),
+      m_Layout(Order)
+  {
+  }
+
+  //! selects the tables of the layout of the grid, false if its regions are not all of Size cells
+  bool Select(const CGrid & grid)
+  {
+    if(grid.isStandard())
+    {
+      m_Tables = &CGridTraits<Order>::Standard();
+      return true;
+    }
+
+    if(NULL == m_Variant.get())
+    {
+      m_Variant.reset(new Tables());
+    }
+    else if(grid.hasSameLayout(m_Layout))
+    {
+      m_Tables = m_Variant.get();
+      return true;
+    }
+
+    m_Tables = &CGridTraits<Order>::Standard();
+    m_Layout = CGrid(Order);
+
+    if(!m_Variant->Build(grid))
+    {
+      return false;
+    }
+
+    m_Layout.SetLayout(grid);
+    m_Tables = m_Variant.get();
+
+    return true;
+  }
+
+  //! uses the tables selected by another instance, as long as that one does not select others
+  void Share(const CLayoutTables & other) { m_Tables = other.m_Tables; }
+
+  //! true for the tables of the plain layout
+  bool isStandard() const { return m_Tables == &CGridTraits<Order>::Standard(); }
+
+  //! the selected tables
+  const Tables & operator*() const { return *m_Tables; }
+  const Tables* operator->() const { return m_Tables; }
+
+private:
+  CLayoutTables(const CLayoutTables &); // not impl.
+
+  const Tables*           m_Tables;
+  std::unique_ptr<Tables> m_Variant;    // built for the last other layout
+  CGrid                   m_Layout;     // the layout m_Variant was built for
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sudoku
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // SolverTraits_h__